@@ -0,0 +1,116 @@
+#include "Any.hpp"
+#include "Bench.hpp"
+
+#include <memory>
+#include <string>
+
+namespace {
+
+// The previous Any design, kept as the reference point: every value on the
+// heap behind a virtual 'Base', checked with dynamic_cast on every access.
+class LegacyAny {
+  struct Base {
+    virtual ~Base() = default;
+    virtual std::unique_ptr<Base> Clone() const = 0;
+  };
+
+  template <typename T>
+  struct Derive : Base {
+    explicit Derive(const T &value) : elem_(value) {}
+
+    std::unique_ptr<Base> Clone() const override {
+      return std::make_unique<Derive>(elem_);
+    }
+
+    T elem_;
+  };
+
+public:
+  template <typename T>
+  explicit LegacyAny(const T &value) : data_(std::make_unique<Derive<T>>(value)) {}
+
+  LegacyAny(const LegacyAny &other) : data_(other.data_->Clone()) {}
+
+  LegacyAny(LegacyAny &&) noexcept = default;
+
+  template <typename T>
+  T* Cast() const {
+    if (auto ptr = dynamic_cast<Derive<T>*>(data_.get())) {
+      return &ptr->elem_;
+    }
+    return nullptr;
+  }
+
+private:
+  std::unique_ptr<Base> data_;
+};
+
+template <typename Holder>
+void CastHit(std::size_t iterations) {
+  Holder any(42);
+  long sum = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(any);
+    sum += *any.template Cast<int>();
+  }
+  tystl::bench::DoNotOptimize(sum);
+}
+
+template <typename Holder>
+void CastMiss(std::size_t iterations) {
+  Holder any(42);
+  std::size_t misses = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(any);
+    misses += any.template Cast<double>() == nullptr;
+  }
+  tystl::bench::DoNotOptimize(misses);
+}
+
+void UnsafeCast(std::size_t iterations) {
+  tystl::Any any(42);
+  long sum = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(any);
+    sum += *any.UnsafeCast<int>();
+  }
+  tystl::bench::DoNotOptimize(sum);
+}
+
+template <typename Holder, typename T>
+void Copy(std::size_t iterations) {
+  Holder any(T{});
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Holder copy(any);
+    tystl::bench::DoNotOptimize(copy);
+  }
+}
+
+template <typename Holder, typename T>
+void Move(std::size_t iterations) {
+  Holder any(T{});
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Holder moved(tystl::Move(any));
+    tystl::bench::DoNotOptimize(moved);
+    any = Holder(tystl::Move(moved));
+  }
+}
+
+struct Large {
+  char bytes[128]{};
+};
+
+[[maybe_unused]] const bool registered =
+  tystl::bench::Register("Any/CastHit/Legacy", CastHit<LegacyAny>) &&
+  tystl::bench::Register("Any/CastHit/Tagged", CastHit<tystl::Any>) &&
+  tystl::bench::Register("Any/CastMiss/Legacy", CastMiss<LegacyAny>) &&
+  tystl::bench::Register("Any/CastMiss/Tagged", CastMiss<tystl::Any>) &&
+  tystl::bench::Register("Any/UnsafeCast/Tagged", UnsafeCast) &&
+  tystl::bench::Register("Any/Copy/int/Legacy", Copy<LegacyAny, int>) &&
+  tystl::bench::Register("Any/Copy/int/Tagged", Copy<tystl::Any, int>) &&
+  tystl::bench::Register("Any/Copy/Large/Legacy", Copy<LegacyAny, Large>) &&
+  tystl::bench::Register("Any/Copy/Large/Tagged", Copy<tystl::Any, Large>) &&
+  tystl::bench::Register("Any/Move/int/Tagged", Move<tystl::Any, int>) &&
+  tystl::bench::Register("Any/Move/string/Tagged", Move<tystl::Any, std::string>);
+
+} // namespace
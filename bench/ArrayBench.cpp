@@ -0,0 +1,167 @@
+#include "Array.hpp"
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The element by element loops Array used before, as the reference point.
+template <typename T, std::size_t N>
+bool ScalarEqual(const tystl::Array<T, N> &left, const tystl::Array<T, N> &right) {
+  for (std::size_t i = 0; i < N; i ++) {
+    if (left[i] != right[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, std::size_t N>
+std::strong_ordering ScalarCompare(const tystl::Array<T, N> &left, const tystl::Array<T, N> &right) {
+  for (std::size_t i = 0; i < N; i ++) {
+    if (auto result = left[i] <=> right[i]; result != 0) {
+      return result;
+    }
+  }
+  return std::strong_ordering::equal;
+}
+
+// Two keys that only differ in their last element, the worst case for a
+// comparison.
+template <typename T, std::size_t N>
+std::pair<tystl::Array<T, N>, tystl::Array<T, N>> MakeKeys() {
+  std::mt19937_64 rng(42);
+  tystl::Array<T, N> left;
+  for (std::size_t i = 0; i < N; i ++) {
+    left[i] = static_cast<T>(rng());
+  }
+  auto right = left;
+  right[N - 1] = static_cast<T>(right[N - 1] + 1);
+  return {left, right};
+}
+
+template <typename T, std::size_t N, bool Fast>
+void Equal(std::size_t iterations) {
+  auto [left, right] = MakeKeys<T, N>();
+  std::size_t equal = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(left);
+    if constexpr (Fast) {
+      equal += left == right;
+    } else {
+      equal += ScalarEqual(left, right);
+    }
+  }
+  tystl::bench::DoNotOptimize(equal);
+}
+
+template <typename T, std::size_t N, bool Fast>
+void Compare(std::size_t iterations) {
+  auto [left, right] = MakeKeys<T, N>();
+  std::size_t less = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(left);
+    if constexpr (Fast) {
+      less += (left <=> right) < 0;
+    } else {
+      less += ScalarCompare(left, right) < 0;
+    }
+  }
+  tystl::bench::DoNotOptimize(less);
+}
+
+template <typename T, std::size_t N>
+void Hash(std::size_t iterations) {
+  auto [left, right] = MakeKeys<T, N>();
+  std::size_t hash = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(left);
+    hash ^= left.Hash();
+  }
+  tystl::bench::DoNotOptimize(hash);
+}
+
+// Large enough that the parallel algorithms have work to split.
+constexpr std::size_t kLargeSize = std::size_t{1} << 20;
+
+using LargeArray = tystl::Array<std::uint32_t, kLargeSize>;
+
+std::unique_ptr<LargeArray> MakeLarge() {
+  auto array = std::make_unique<LargeArray>();
+  std::mt19937 rng(42);
+  std::generate(array->begin(), array->end(), std::ref(rng));
+  return array;
+}
+
+// Sums the Array in place with the given execution policy.
+template <typename Policy>
+void Reduce(Policy policy, std::size_t iterations) {
+  auto array = MakeLarge();
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto sum = std::reduce(policy, array->begin(), array->end(), std::uint64_t{0});
+    tystl::bench::DoNotOptimize(sum);
+  }
+}
+
+// What callers did before Array had iterators: copy into a vector first.
+void ReduceViaVector(std::size_t iterations) {
+  auto array = MakeLarge();
+  for (std::size_t i = 0; i < iterations; i ++) {
+    std::vector<std::uint32_t> copy(array->Data(), array->Data() + array->Size());
+    auto sum = std::reduce(std::execution::par, copy.begin(), copy.end(), std::uint64_t{0});
+    tystl::bench::DoNotOptimize(sum);
+  }
+}
+
+// Each iteration restores the shuffled input, which costs the same for
+// every policy.
+template <typename Policy>
+void Sort(Policy policy, std::size_t iterations) {
+  auto input = MakeLarge();
+  auto array = std::make_unique<LargeArray>();
+  for (std::size_t i = 0; i < iterations; i ++) {
+    std::copy(input->begin(), input->end(), array->begin());
+    std::sort(policy, array->begin(), array->end());
+    tystl::bench::DoNotOptimize(array->Front());
+  }
+}
+
+[[maybe_unused]] const bool registered_parallel = [] {
+  tystl::bench::Register("Array/Reduce/Seq", [](std::size_t n) { Reduce(std::execution::seq, n); });
+  tystl::bench::Register("Array/Reduce/ParUnseq", [](std::size_t n) { Reduce(std::execution::par_unseq, n); });
+  tystl::bench::Register("Array/Reduce/Par", [](std::size_t n) { Reduce(std::execution::par, n); });
+  tystl::bench::Register("Array/Reduce/ParViaVector", ReduceViaVector);
+  tystl::bench::Register("Array/Sort/Seq", [](std::size_t n) { Sort(std::execution::seq, n); });
+  tystl::bench::Register("Array/Sort/Par", [](std::size_t n) { Sort(std::execution::par, n); });
+  return true;
+}();
+
+template <typename T, std::size_t Bytes>
+bool RegisterSize(const std::string &element) {
+  constexpr std::size_t N = Bytes / sizeof(T);
+  auto suffix = "/" + element + "/bytes:" + std::to_string(Bytes);
+  tystl::bench::Register("Array/Equal/Scalar" + suffix, Equal<T, N, false>);
+  tystl::bench::Register("Array/Equal/Bytewise" + suffix, Equal<T, N, true>);
+  tystl::bench::Register("Array/Compare/Scalar" + suffix, Compare<T, N, false>);
+  tystl::bench::Register("Array/Compare/Bytewise" + suffix, Compare<T, N, true>);
+  tystl::bench::Register("Array/Hash" + suffix, Hash<T, N>);
+  return true;
+}
+
+template <typename T>
+bool RegisterElement(const std::string &element) {
+  return RegisterSize<T, 16>(element) && RegisterSize<T, 64>(element) && RegisterSize<T, 256>(element) &&
+         RegisterSize<T, 1024>(element) && RegisterSize<T, 4096>(element);
+}
+
+[[maybe_unused]] const bool registered = RegisterElement<std::uint8_t>("u8") &&
+                                         RegisterElement<std::uint32_t>("u32");
+
+} // namespace
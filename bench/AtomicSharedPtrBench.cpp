@@ -0,0 +1,67 @@
+#include "AtomicSharedPtr.hpp"
+#include "Bench.hpp"
+
+#include <mutex>
+#include <string>
+
+namespace {
+
+struct Snapshot {
+  int routes[16]{};
+};
+
+// The alternative to AtomicSharedPtr: a SharedPtr guarded by a mutex.
+class MutexSharedPtr {
+public:
+  explicit MutexSharedPtr(tystl::SharedPtr<Snapshot> ptr) : ptr_(tystl::Move(ptr)) {}
+
+  tystl::SharedPtr<Snapshot> Load() const {
+    std::lock_guard lock(mutex_);
+    return ptr_;
+  }
+
+  void Store(tystl::SharedPtr<Snapshot> ptr) {
+    std::lock_guard lock(mutex_);
+    ptr_.Swap(ptr);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  tystl::SharedPtr<Snapshot> ptr_;
+};
+
+// Every thread loads; with 'write_every' set, thread 0 also publishes a new
+// snapshot once per that many loads.
+template <typename Slot>
+void LoadStore(std::size_t threads, std::size_t write_every, std::size_t iterations) {
+  Slot slot(tystl::MakeShared<Snapshot>());
+  tystl::bench::RunThreads(threads, iterations / threads + 1, [&](std::size_t index, std::size_t count) {
+    for (std::size_t i = 0; i < count; i ++) {
+      if (write_every != 0 && index == 0 && i % write_every == 0) {
+        slot.Store(tystl::MakeShared<Snapshot>());
+        continue;
+      }
+      auto snapshot = slot.Load();
+      tystl::bench::DoNotOptimize(snapshot->routes[0]);
+    }
+  });
+}
+
+template <typename Slot>
+bool RegisterSlot(const std::string &slot) {
+  for (std::size_t threads : {1, 2, 4, 8, 16}) {
+    for (std::size_t write_every : {0, 1024}) {
+      auto name = "AtomicSharedPtr/" + slot + (write_every ? "/LoadStore" : "/Load") +
+                  "/threads:" + std::to_string(threads);
+      tystl::bench::Register(name, [threads, write_every](std::size_t iterations) {
+        LoadStore<Slot>(threads, write_every, iterations);
+      });
+    }
+  }
+  return true;
+}
+
+[[maybe_unused]] const bool registered = RegisterSlot<tystl::AtomicSharedPtr<Snapshot>>("SplitCount") &&
+                                         RegisterSlot<MutexSharedPtr>("Mutex");
+
+} // namespace
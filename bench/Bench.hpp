@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tystl::bench {
+
+// A benchmark body runs the measured operation 'iterations' times.
+using BenchFunc = std::function<void(std::size_t iterations)>;
+
+struct BenchCase {
+  std::string name;
+  BenchFunc func;
+  // Runs once before the case is timed, e.g. to fill a large container.
+  std::function<void()> setup = {};
+};
+
+inline std::vector<BenchCase>& Registry() {
+  static std::vector<BenchCase> cases;
+  return cases;
+}
+
+inline bool Register(std::string name, BenchFunc func) {
+  Registry().push_back({std::move(name), std::move(func)});
+  return true;
+}
+
+// A body that runs 'iterations' operations spread over 'threads' threads.
+using ThreadedFunc = std::function<void(std::size_t threads, std::size_t iterations)>;
+
+struct ThreadedCase {
+  std::string name;
+  ThreadedFunc func;
+};
+
+inline std::vector<ThreadedCase>& ThreadedRegistry() {
+  static std::vector<ThreadedCase> cases;
+  return cases;
+}
+
+// Thread counts every threaded case runs with, set from the command line.
+inline std::vector<std::size_t>& ThreadCounts() {
+  static std::vector<std::size_t> counts{1, 2, 4, 8};
+  return counts;
+}
+
+// Registers 'name/threads:N' for every entry of 'ThreadCounts()'.
+inline bool RegisterThreaded(std::string name, ThreadedFunc func) {
+  ThreadedRegistry().push_back({std::move(name), std::move(func)});
+  return true;
+}
+
+// A body that runs 'iterations' operations on a data set of 'size' entries,
+// built beforehand by the setup.
+using SizedFunc = std::function<void(std::size_t size, std::size_t iterations)>;
+using SizedSetup = std::function<void(std::size_t size)>;
+
+struct SizedCase {
+  std::string name;
+  std::vector<std::size_t> sizes;
+  SizedFunc func;
+  SizedSetup setup;
+};
+
+inline std::vector<SizedCase>& SizedRegistry() {
+  static std::vector<SizedCase> cases;
+  return cases;
+}
+
+// Sizes above this are skipped, so the largest data sets only run when
+// asked for from the command line.
+inline std::size_t& MaxSize() {
+  static std::size_t max = std::size_t{1} << 20;
+  return max;
+}
+
+// Registers 'name/size:N' for every entry of 'sizes' up to 'MaxSize()'.
+inline bool RegisterSized(std::string name, std::vector<std::size_t> sizes, SizedFunc func, SizedSetup setup = {}) {
+  SizedRegistry().push_back({std::move(name), std::move(sizes), std::move(func), std::move(setup)});
+  return true;
+}
+
+// Every registered case, threaded ones expanded for the current thread counts
+// and sized ones for the sizes up to 'MaxSize()'.
+inline std::vector<BenchCase> AllCases() {
+  auto cases = Registry();
+  for (const auto &threaded : ThreadedRegistry()) {
+    for (auto threads : ThreadCounts()) {
+      cases.push_back({threaded.name + "/threads:" + std::to_string(threads),
+                       [func = threaded.func, threads](std::size_t iterations) { func(threads, iterations); }});
+    }
+  }
+  for (const auto &sized : SizedRegistry()) {
+    for (auto size : sized.sizes) {
+      if (size > MaxSize()) {
+        continue;
+      }
+      std::function<void()> setup;
+      if (sized.setup) {
+        setup = [setup = sized.setup, size] { setup(size); };
+      }
+      cases.push_back({sized.name + "/size:" + std::to_string(size),
+                       [func = sized.func, size](std::size_t iterations) { func(size, iterations); },
+                       std::move(setup)});
+    }
+  }
+  return cases;
+}
+
+// Keeps the compiler from discarding a value computed by the benchmark.
+template <typename T>
+inline void DoNotOptimize(T &value) {
+  asm volatile("" : "+m"(value) : : "memory");
+}
+
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "m"(value) : "memory");
+}
+
+inline void ClobberMemory() {
+  asm volatile("" : : : "memory");
+}
+
+// Runs 'func(thread_index, iterations)' on 'threads' threads that start
+// together, so the timed region covers the contended part only.
+template <typename Func>
+void RunThreads(std::size_t threads, std::size_t iterations, Func &&func) {
+  std::barrier start(static_cast<std::ptrdiff_t>(threads));
+  std::vector<std::jthread> workers;
+  workers.reserve(threads);
+  for (std::size_t i = 0; i < threads; i ++) {
+    workers.emplace_back([&, i] {
+      start.arrive_and_wait();
+      func(i, iterations);
+    });
+  }
+}
+
+// Totals of something other than time, such as allocations, counted by the
+// running case and reported per iteration.
+using Counters = std::vector<std::pair<std::string, double>>;
+
+inline Counters& CurrentCounters() {
+  static Counters counters;
+  return counters;
+}
+
+// Records 'total' for the current run of the case, replacing an earlier value.
+inline void SetCounter(std::string name, double total) {
+  for (auto &[counter, value] : CurrentCounters()) {
+    if (counter == name) {
+      value = total;
+      return;
+    }
+  }
+  CurrentCounters().emplace_back(std::move(name), total);
+}
+
+struct BenchResult {
+  std::string name;
+  std::size_t iterations;
+  double ns_per_op;
+  Counters counters_per_op;
+};
+
+// Grows the iteration count until a run takes at least 'min_time'.
+inline BenchResult RunCase(const BenchCase &bench,
+                           std::chrono::nanoseconds min_time = std::chrono::milliseconds(100)) {
+  using Clock = std::chrono::steady_clock;
+
+  if (bench.setup) {
+    bench.setup();
+  }
+  std::size_t iterations = 1;
+  while (true) {
+    CurrentCounters().clear();
+    auto start = Clock::now();
+    bench.func(iterations);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+    if (elapsed >= min_time || iterations >= (std::size_t{1} << 40)) {
+      auto counters = CurrentCounters();
+      for (auto &[counter, value] : counters) {
+        value /= static_cast<double>(iterations);
+      }
+      return {bench.name, iterations, static_cast<double>(elapsed.count()) / static_cast<double>(iterations),
+              std::move(counters)};
+    }
+
+    auto scale = elapsed.count() > 0
+                   ? static_cast<double>(min_time.count()) * 1.4 / static_cast<double>(elapsed.count())
+                   : 100.0;
+    iterations = static_cast<std::size_t>(static_cast<double>(iterations) * std::clamp(scale, 2.0, 100.0));
+  }
+}
+
+} // namespace tystl::bench
+
+#define TYSTL_BENCH_CONCAT_IMPL(left, right) left##right
+#define TYSTL_BENCH_CONCAT(left, right) TYSTL_BENCH_CONCAT_IMPL(left, right)
+
+// Defines a benchmark body 'void name(std::size_t iterations)' and registers it.
+#define TYSTL_BENCH(name)                                                       \
+  static void name(std::size_t iterations);                                     \
+  [[maybe_unused]] static const bool TYSTL_BENCH_CONCAT(name, Registered) =     \
+    ::tystl::bench::Register(#name, name);                                      \
+  static void name(std::size_t iterations)
@@ -0,0 +1,92 @@
+#include "BinaryHeap.hpp"
+#include "Bench.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <std::size_t Bytes>
+struct Element {
+  std::uint64_t key;
+  char payload[Bytes - sizeof(std::uint64_t)]{};
+};
+
+struct KeyLess {
+  template <typename T>
+  bool operator()(const T &left, const T &right) const noexcept {
+    return left.key < right.key;
+  }
+};
+
+std::vector<std::uint64_t> MakeKeys(std::size_t count) {
+  std::mt19937_64 rng(20240601);
+  std::vector<std::uint64_t> keys(count);
+  for (auto &key : keys) {
+    key = rng();
+  }
+  return keys;
+}
+
+// Pushes 'size' elements, then drains the heap; one iteration is one push
+// and one pop.
+template <typename T, std::size_t Arity>
+void FillDrain(std::size_t size, std::size_t iterations) {
+  auto keys = MakeKeys(size);
+  tystl::BinaryHeap<T, KeyLess, std::vector<T>, Arity> heap;
+  for (std::size_t done = 0; done < iterations; done += size) {
+    for (auto key : keys) {
+      heap.Push(T{key});
+    }
+    while (!heap.Empty()) {
+      tystl::bench::DoNotOptimize(heap.Top());
+      heap.Pop();
+    }
+  }
+}
+
+// Keeps the heap at 'size' elements, each iteration pops the top and pushes
+// a later key, which is how timer queues behave.
+template <typename T, std::size_t Arity>
+void SteadyPopPush(std::size_t size, std::size_t iterations) {
+  auto keys = MakeKeys(size);
+  tystl::BinaryHeap<T, KeyLess, std::vector<T>, Arity> heap;
+  for (auto key : keys) {
+    heap.Push(T{key});
+  }
+  std::uint64_t step = 0x9E3779B97F4A7C15ULL;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto top = heap.Top().key;
+    heap.Pop();
+    heap.Push(T{top + (step ^= step << 7) % (std::uint64_t{1} << 40)});
+  }
+  tystl::bench::DoNotOptimize(heap.Top());
+}
+
+template <typename T, std::size_t Arity>
+bool RegisterArity(const std::string &element) {
+  for (std::size_t size : {1 << 10, 1 << 16, 1 << 20}) {
+    auto suffix = element + "/arity:" + std::to_string(Arity) + "/size:" + std::to_string(size);
+    tystl::bench::Register("BinaryHeap/FillDrain/" + suffix, [size](std::size_t iterations) {
+      FillDrain<T, Arity>(size, iterations);
+    });
+    tystl::bench::Register("BinaryHeap/SteadyPopPush/" + suffix, [size](std::size_t iterations) {
+      SteadyPopPush<T, Arity>(size, iterations);
+    });
+  }
+  return true;
+}
+
+template <typename T>
+bool RegisterElement(const std::string &element) {
+  return RegisterArity<T, 2>(element) && RegisterArity<T, 4>(element) && RegisterArity<T, 8>(element);
+}
+
+[[maybe_unused]] const bool registered = RegisterElement<Element<8>>("8B") &&
+                                         RegisterElement<Element<32>>("32B") &&
+                                         RegisterElement<Element<128>>("128B");
+
+} // namespace
@@ -0,0 +1,78 @@
+#include "Bench.hpp"
+#include "BinaryHeap.hpp"
+#include "ConcurrentPriorityQueue.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace {
+
+// The baseline: one BinaryHeap behind one mutex.
+class MutexHeap {
+public:
+  void Push(std::uint64_t value) {
+    std::lock_guard lock(mutex_);
+    heap_.Push(value);
+  }
+
+  bool TryPop(std::uint64_t &out) {
+    std::lock_guard lock(mutex_);
+    if (heap_.Empty()) {
+      return false;
+    }
+    out = heap_.Top();
+    heap_.Pop();
+    return true;
+  }
+
+private:
+  std::mutex mutex_;
+  tystl::BinaryHeap<std::uint64_t, std::less<std::uint64_t>> heap_;
+};
+
+using MultiQueue = tystl::ConcurrentPriorityQueue<std::uint64_t, std::less<std::uint64_t>>;
+
+constexpr std::size_t kPrefill = 1 << 14;
+
+// Every thread alternates one push and one pop, one iteration is one pair.
+template <typename Queue>
+void PushPop(Queue &queue, std::size_t threads, std::size_t iterations) {
+  for (std::size_t i = 0; i < kPrefill; i ++) {
+    queue.Push(i * 0x9E3779B97F4A7C15ULL >> 20);
+  }
+  tystl::bench::RunThreads(threads, iterations / threads + 1, [&](std::size_t index, std::size_t count) {
+    std::uint64_t key = index * 0x2545F4914F6CDD1DULL;
+    std::uint64_t out = 0;
+    for (std::size_t i = 0; i < count; i ++) {
+      key ^= key << 13;
+      key ^= key >> 7;
+      key ^= key << 17;
+      queue.Push(key >> 20);
+      queue.TryPop(out);
+    }
+    tystl::bench::DoNotOptimize(out);
+  });
+}
+
+[[maybe_unused]] const bool registered = [] {
+  for (std::size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+    auto suffix = "/threads:" + std::to_string(threads);
+    tystl::bench::Register("ConcurrentPriorityQueue/PushPop/Mutex" + suffix, [threads](std::size_t iterations) {
+      MutexHeap queue;
+      PushPop(queue, threads, iterations);
+    });
+    tystl::bench::Register("ConcurrentPriorityQueue/PushPop/Relaxed" + suffix, [threads](std::size_t iterations) {
+      MultiQueue queue;
+      PushPop(queue, threads, iterations);
+    });
+    tystl::bench::Register("ConcurrentPriorityQueue/PushPop/Strict" + suffix, [threads](std::size_t iterations) {
+      MultiQueue queue({.shards = 0, .strict = true});
+      PushPop(queue, threads, iterations);
+    });
+  }
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,218 @@
+// FlatHashMap against std::unordered_map with the same keys. Every case runs
+// at 1K to 100M entries; sizes past '--max-size' (1M by default) are
+// skipped, as the largest tables take gigabytes.
+
+#include "Bench.hpp"
+#include "FlatHashMap.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t kSeed = 20240601;
+
+const std::vector<std::size_t> kSizes = {1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000};
+
+// Lets a std::unordered_map keyed by std::string be searched by string_view,
+// as FlatHashMap can be by default.
+struct StdStringHash {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view value) const noexcept {
+    return std::hash<std::string_view>{}(value);
+  }
+};
+
+using TyMap = tystl::FlatHashMap<std::uint64_t, std::uint64_t>;
+using StdMap = std::unordered_map<std::uint64_t, std::uint64_t>;
+using TyStringMap = tystl::FlatHashMap<std::string, std::uint64_t>;
+using StdStringMap = std::unordered_map<std::string, std::uint64_t, StdStringHash, std::equal_to<>>;
+
+template <typename Map, typename Key>
+bool Contains(const Map &map, const Key &key) {
+  if constexpr (requires { map.Contains(key); }) {
+    return map.Contains(key);
+  } else {
+    return map.find(key) != map.end();
+  }
+}
+
+template <typename Map, typename Key>
+void Insert(Map &map, Key key, std::uint64_t value) {
+  if constexpr (requires { map.TryEmplace(tystl::Move(key), value); }) {
+    map.TryEmplace(tystl::Move(key), value);
+  } else {
+    map.try_emplace(tystl::Move(key), value);
+  }
+}
+
+template <typename Map, typename Key>
+void Erase(Map &map, const Key &key) {
+  if constexpr (requires { map.Erase(key); }) {
+    map.Erase(key);
+  } else {
+    map.erase(key);
+  }
+}
+
+std::uint64_t MakeKey(std::mt19937_64 &rng, std::uint64_t) {
+  return rng();
+}
+
+// Strings of 12 to 24 characters, mostly past the small string buffer of
+// the standard libraries.
+std::string MakeKey(std::mt19937_64 &rng, std::string) {
+  auto value = rng();
+  return "key-" + std::to_string(value).substr(0, 8 + value % 13);
+}
+
+// 'size' keys in a map, and as many keys that are not in it.
+template <typename Map>
+struct Table {
+  using Key = typename Map::key_type;
+
+  explicit Table(std::size_t size) {
+    std::mt19937_64 rng(kSeed);
+    keys.reserve(size);
+    while (keys.size() < size) {
+      auto key = MakeKey(rng, Key{});
+      if (!Contains(map, key)) {
+        Insert(map, key, keys.size());
+        keys.push_back(tystl::Move(key));
+      }
+    }
+    misses.reserve(size);
+    while (misses.size() < size) {
+      auto key = MakeKey(rng, Key{});
+      if (!Contains(map, key)) {
+        misses.push_back(tystl::Move(key));
+      }
+    }
+  }
+
+  Map map;
+  std::vector<Key> keys;
+  std::vector<Key> misses;
+};
+
+struct DataSet {
+  const void *tag = nullptr;
+  std::size_t size = 0;
+  std::shared_ptr<void> table;
+};
+
+DataSet& Loaded() {
+  static DataSet loaded;
+  return loaded;
+}
+
+// The data set of the running case. Only one is alive at a time, whatever
+// the map type, so the largest sizes fit in memory.
+template <typename Map>
+Table<Map>& Current(std::size_t size) {
+  static const char tag = 0;
+  auto &current = Loaded();
+  if (current.tag != &tag || current.size != size) {
+    current.table.reset();
+    current.table = std::make_shared<Table<Map>>(size);
+    current.tag = &tag;
+    current.size = size;
+  }
+  return *static_cast<Table<Map>*>(current.table.get());
+}
+
+template <typename Map>
+void Prepare(std::size_t size) {
+  Current<Map>(size);
+}
+
+template <typename Map>
+void FindHit(std::size_t size, std::size_t iterations) {
+  auto &table = Current<Map>(size);
+  std::size_t found = 0;
+  for (std::size_t i = 0, k = 0; i < iterations; i ++, k = k + 1 == size ? 0 : k + 1) {
+    found += Contains(table.map, table.keys[k]);
+  }
+  tystl::bench::DoNotOptimize(found);
+}
+
+template <typename Map>
+void FindMiss(std::size_t size, std::size_t iterations) {
+  auto &table = Current<Map>(size);
+  std::size_t found = 0;
+  for (std::size_t i = 0, k = 0; i < iterations; i ++, k = k + 1 == size ? 0 : k + 1) {
+    found += Contains(table.map, table.misses[k]);
+  }
+  tystl::bench::DoNotOptimize(found);
+}
+
+// Looks up std::string keys through a string_view, without building a
+// std::string per lookup.
+template <typename Map>
+void FindView(std::size_t size, std::size_t iterations) {
+  auto &table = Current<Map>(size);
+  std::size_t found = 0;
+  for (std::size_t i = 0, k = 0; i < iterations; i ++, k = k + 1 == size ? 0 : k + 1) {
+    found += Contains(table.map, std::string_view(table.keys[k]));
+  }
+  tystl::bench::DoNotOptimize(found);
+}
+
+// Fills a new map with the keys one at a time, growing it as it goes, and
+// starts over when it holds 'size' of them.
+template <typename Map>
+void Grow(std::size_t size, std::size_t iterations) {
+  auto &table = Current<Map>(size);
+  auto map = std::make_unique<Map>();
+  for (std::size_t i = 0, k = 0; i < iterations; i ++, k ++) {
+    if (k == size) {
+      map = std::make_unique<Map>();
+      k = 0;
+    }
+    Insert(*map, table.keys[k], i);
+  }
+  tystl::bench::DoNotOptimize(map);
+}
+
+// Erases a present key and inserts a missing key in its place, so the size
+// stays at 'size' and the table keeps its capacity.
+template <typename Map>
+void EraseInsert(std::size_t size, std::size_t iterations) {
+  auto &table = Current<Map>(size);
+  for (std::size_t i = 0, k = 0; i < iterations; i ++, k = k + 1 == size ? 0 : k + 1) {
+    Erase(table.map, table.keys[k]);
+    Insert(table.map, table.misses[k], i);
+    std::swap(table.keys[k], table.misses[k]);
+  }
+  tystl::bench::DoNotOptimize(table.map);
+}
+
+template <typename Ty, typename Std>
+void RegisterPair(const std::string &name, void (*ty_case)(std::size_t, std::size_t),
+                  void (*std_case)(std::size_t, std::size_t)) {
+  tystl::bench::RegisterSized(name + "/tystl", kSizes, ty_case, Prepare<Ty>);
+  tystl::bench::RegisterSized(name + "/std", kSizes, std_case, Prepare<Std>);
+}
+
+[[maybe_unused]] const bool registered = [] {
+  RegisterPair<TyMap, StdMap>("FlatHashMap/Find/hit/u64", FindHit<TyMap>, FindHit<StdMap>);
+  RegisterPair<TyMap, StdMap>("FlatHashMap/Find/miss/u64", FindMiss<TyMap>, FindMiss<StdMap>);
+  RegisterPair<TyMap, StdMap>("FlatHashMap/Insert/u64", Grow<TyMap>, Grow<StdMap>);
+  RegisterPair<TyMap, StdMap>("FlatHashMap/EraseInsert/u64", EraseInsert<TyMap>, EraseInsert<StdMap>);
+  RegisterPair<TyStringMap, StdStringMap>("FlatHashMap/Find/hit/string", FindHit<TyStringMap>,
+                                          FindHit<StdStringMap>);
+  RegisterPair<TyStringMap, StdStringMap>("FlatHashMap/Find/view/string", FindView<TyStringMap>,
+                                          FindView<StdStringMap>);
+  RegisterPair<TyStringMap, StdStringMap>("FlatHashMap/Insert/string", Grow<TyStringMap>,
+                                          Grow<StdStringMap>);
+  return true;
+}();
+
+} // namespace
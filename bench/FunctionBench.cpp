@@ -0,0 +1,111 @@
+// Function, MoveOnlyFunction and FunctionRef against std::function. With
+// libstdc++ std::function keeps targets of up to two pointers inline and
+// allocates for anything bigger; Function keeps up to three inline.
+
+#include "Bench.hpp"
+#include "Function.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// One iteration is one call through the wrapper.
+template <typename Wrapper>
+void Call(std::size_t iterations) {
+  std::uint64_t total = 0;
+  std::uint64_t step = 3;
+  Wrapper func = [&total, &step](std::uint64_t value) { total += value * step; };
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(func);
+    func(i);
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+void CallFunctionRef(std::size_t iterations) {
+  std::uint64_t total = 0;
+  std::uint64_t step = 3;
+  auto lambda = [&total, &step](std::uint64_t value) { total += value * step; };
+  tystl::FunctionRef<void(std::uint64_t)> func = lambda;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(func);
+    func(i);
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+// A capture of 'Words' pointer sized words.
+template <std::size_t Words>
+struct Capture {
+  std::uint64_t words[Words];
+
+  std::uint64_t operator()(std::uint64_t value) const {
+    return value + words[0] + words[Words - 1];
+  }
+};
+
+// One iteration builds a wrapper around a 'Words' word target, calls it
+// once and destroys it, as a timer entry would.
+template <typename Wrapper, std::size_t Words>
+void Construct(std::size_t iterations) {
+  std::uint64_t total = 0;
+  Capture<Words> capture{};
+  for (std::size_t i = 0; i < iterations; i ++) {
+    capture.words[0] = i;
+    Wrapper func = capture;
+    tystl::bench::DoNotOptimize(func);
+    total += func(i);
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+// One iteration moves a three word callback into a queue and, once 64 are
+// queued, they all run and the queue is cleared.
+template <typename Wrapper>
+void Queue(std::size_t iterations) {
+  std::vector<Wrapper> queue;
+  queue.reserve(64);
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Wrapper func = Capture<3>{{i, i + 1, i + 2}};
+    queue.push_back(std::move(func));
+    if (queue.size() == 64) {
+      for (auto &entry : queue) {
+        total += entry(1);
+      }
+      queue.clear();
+    }
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+using StdFunc = std::function<std::uint64_t(std::uint64_t)>;
+using TyFunc = tystl::Function<std::uint64_t(std::uint64_t)>;
+using TyMoveOnly = tystl::MoveOnlyFunction<std::uint64_t(std::uint64_t)>;
+
+template <std::size_t Words>
+bool RegisterConstruct(const char *size) {
+  using tystl::bench::Register;
+  auto prefix = std::string("Function/Construct/") + size + "/";
+  Register(prefix + "std::function", Construct<StdFunc, Words>);
+  Register(prefix + "Function", Construct<TyFunc, Words>);
+  Register(prefix + "MoveOnlyFunction", Construct<TyMoveOnly, Words>);
+  return true;
+}
+
+[[maybe_unused]] const bool registered =
+  tystl::bench::Register("Function/Call/std::function", Call<std::function<void(std::uint64_t)>>) &&
+  tystl::bench::Register("Function/Call/Function", Call<tystl::Function<void(std::uint64_t)>>) &&
+  tystl::bench::Register("Function/Call/MoveOnlyFunction", Call<tystl::MoveOnlyFunction<void(std::uint64_t)>>) &&
+  tystl::bench::Register("Function/Call/FunctionRef", CallFunctionRef) &&
+  RegisterConstruct<2>("words:2") &&
+  RegisterConstruct<3>("words:3") &&
+  RegisterConstruct<8>("words:8") &&
+  tystl::bench::Register("Function/Queue/std::function", Queue<StdFunc>) &&
+  tystl::bench::Register("Function/Queue/Function", Queue<TyFunc>) &&
+  tystl::bench::Register("Function/Queue/MoveOnlyFunction", Queue<TyMoveOnly>);
+
+} // namespace
@@ -0,0 +1,57 @@
+#include "Bench.hpp"
+#include "Report.hpp"
+
+#include <cstdio>
+
+int main(int argc, char **argv) {
+  using namespace tystl::bench;
+
+  auto options = ParseOptions(argc, argv);
+  if (!options) {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+
+  // Machine readable output written to standard output moves the table to
+  // standard error so the two do not mix.
+  auto machine = options->format != Format::kTable;
+  auto *table = machine && options->out.empty() ? stderr : stdout;
+
+  std::vector<BenchResult> results;
+  PrintHeader(table);
+  for (const auto &bench : AllCases()) {
+    if (bench.name.find(options->filter) == std::string::npos) {
+      continue;
+    }
+    results.push_back(RunCase(bench, options->min_time));
+    PrintRow(table, results.back());
+  }
+
+  if (machine) {
+    auto *file = options->out.empty() ? stdout : std::fopen(options->out.c_str(), "w");
+    if (file == nullptr) {
+      std::fprintf(stderr, "cannot write %s\n", options->out.c_str());
+      return 2;
+    }
+    if (options->format == Format::kCsv) {
+      WriteCsv(file, results);
+    } else {
+      WriteJson(file, results);
+    }
+    if (file != stdout) {
+      std::fclose(file);
+    }
+  }
+
+  if (!options->baseline.empty()) {
+    auto baseline = ReadBaseline(options->baseline);
+    if (!baseline) {
+      std::fprintf(stderr, "cannot read %s\n", options->baseline.c_str());
+      return 2;
+    }
+    if (CompareBaseline(table, results, *baseline, options->threshold) != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
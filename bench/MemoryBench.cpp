@@ -0,0 +1,69 @@
+#include "Arena.hpp"
+#include "Bench.hpp"
+#include "Pool.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+// Objects made and dropped per request; sizes cycle through 16..512 bytes.
+constexpr std::size_t kBatch = 64;
+
+constexpr std::size_t SizeOf(std::size_t i) noexcept {
+  return 16 + (i * 40) % 497;
+}
+
+struct Malloc {
+  void* Allocate(std::size_t bytes) { return std::malloc(bytes); }
+  void Deallocate(void *ptr, std::size_t) { std::free(ptr); }
+  void EndBatch() {}
+};
+
+struct PoolSource {
+  void* Allocate(std::size_t bytes) { return tystl::Pool::Allocate(bytes); }
+  void Deallocate(void *ptr, std::size_t bytes) { tystl::Pool::Deallocate(ptr, bytes); }
+  void EndBatch() {}
+};
+
+// Drops the whole batch with one Reset instead of freeing each object.
+struct ArenaSource {
+  tystl::Arena arena;
+  void* Allocate(std::size_t bytes) { return arena.Allocate(bytes); }
+  void Deallocate(void *, std::size_t) {}
+  void EndBatch() { arena.Reset(); }
+};
+
+// Every thread serves its own requests; one iteration is one request of
+// 'kBatch' allocations and frees.
+template <typename Source>
+void Requests(std::size_t threads, std::size_t iterations) {
+  tystl::bench::RunThreads(threads, iterations / threads + 1, [](std::size_t, std::size_t count) {
+    Source source;
+    void *ptrs[kBatch];
+    for (std::size_t i = 0; i < count; i ++) {
+      for (std::size_t k = 0; k < kBatch; k ++) {
+        ptrs[k] = source.Allocate(SizeOf(k));
+        static_cast<char*>(ptrs[k])[0] = static_cast<char>(k);
+      }
+      tystl::bench::DoNotOptimize(ptrs);
+      for (std::size_t k = 0; k < kBatch; k ++) {
+        source.Deallocate(ptrs[k], SizeOf(k));
+      }
+      source.EndBatch();
+    }
+  });
+}
+
+[[maybe_unused]] const bool registered = [] {
+  for (std::size_t threads : {1, 2, 4, 8}) {
+    auto suffix = "/threads:" + std::to_string(threads);
+    tystl::bench::Register("Memory/Requests/malloc" + suffix, [=](std::size_t n) { Requests<Malloc>(threads, n); });
+    tystl::bench::Register("Memory/Requests/Pool" + suffix, [=](std::size_t n) { Requests<PoolSource>(threads, n); });
+    tystl::bench::Register("Memory/Requests/Arena" + suffix, [=](std::size_t n) { Requests<ArenaSource>(threads, n); });
+  }
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,211 @@
+// SpscQueue and MpmcQueue against a std::deque behind a std::mutex.
+// Throughput cases count one pushed and popped element per iteration;
+// round trip cases count one message sent to another thread and back, so
+// half of it is the one way latency.
+
+#include "Backoff.hpp"
+#include "Bench.hpp"
+#include "MpmcQueue.hpp"
+#include "SpscQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t kCapacity = 1024;
+
+// The baseline: every operation takes the lock.
+class MutexQueue {
+public:
+  explicit MutexQueue(std::size_t capacity) : capacity_(capacity) {}
+
+  bool TryPush(std::uint64_t value) {
+    std::lock_guard lock(mutex_);
+    if (queue_.size() == capacity_) {
+      return false;
+    }
+    queue_.push_back(value);
+    return true;
+  }
+
+  bool TryPop(std::uint64_t &out) {
+    std::lock_guard lock(mutex_);
+    if (queue_.empty()) {
+      return false;
+    }
+    out = queue_.front();
+    queue_.pop_front();
+    return true;
+  }
+
+  std::size_t PushN(const std::uint64_t *values, std::size_t count) {
+    std::lock_guard lock(mutex_);
+    auto room = capacity_ - queue_.size();
+    count = count < room ? count : room;
+    queue_.insert(queue_.end(), values, values + count);
+    return count;
+  }
+
+  std::size_t PopN(std::uint64_t *out, std::size_t count) {
+    std::lock_guard lock(mutex_);
+    count = count < queue_.size() ? count : queue_.size();
+    std::copy_n(queue_.begin(), count, out);
+    queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(count));
+    return count;
+  }
+
+private:
+  std::mutex mutex_;
+  std::deque<std::uint64_t> queue_;
+  std::size_t capacity_;
+};
+
+template <typename Queue>
+std::unique_ptr<Queue> MakeQueue() {
+  if constexpr (requires { Queue(kCapacity); }) {
+    return std::make_unique<Queue>(kCapacity);
+  } else {
+    return std::make_unique<Queue>();
+  }
+}
+
+// Sends 'count' values, 'batch' at a time with PushN if 'batch' > 1.
+template <typename Queue>
+void Produce(Queue &queue, std::size_t count, std::size_t batch) {
+  tystl::Backoff backoff;
+  std::uint64_t values[64];
+  for (std::size_t sent = 0; sent < count;) {
+    std::size_t pushed;
+    if (batch == 1) {
+      pushed = queue.TryPush(std::uint64_t{sent});
+    } else {
+      auto want = count - sent < batch ? count - sent : batch;
+      for (std::size_t i = 0; i < want; i++) {
+        values[i] = sent + i;
+      }
+      pushed = queue.PushN(values, want);
+    }
+    if (pushed == 0) {
+      backoff.Pause();
+      continue;
+    }
+    backoff.Reset();
+    sent += pushed;
+  }
+}
+
+// Receives until 'received' reaches 'total' across all consumers.
+template <typename Queue>
+void Consume(Queue &queue, std::atomic<std::size_t> &received, std::size_t total, std::size_t batch) {
+  tystl::Backoff backoff;
+  std::uint64_t values[64];
+  std::uint64_t sum = 0;
+  while (received.load(std::memory_order_relaxed) < total) {
+    std::size_t popped;
+    if (batch == 1) {
+      popped = queue.TryPop(values[0]);
+    } else {
+      popped = queue.PopN(values, batch);
+    }
+    if (popped == 0) {
+      backoff.Pause();
+      continue;
+    }
+    backoff.Reset();
+    for (std::size_t i = 0; i < popped; i++) {
+      sum += values[i];
+    }
+    received.fetch_add(popped, std::memory_order_relaxed);
+  }
+  tystl::bench::DoNotOptimize(sum);
+}
+
+// 'producers' threads each send their share of 'iterations' values to
+// 'consumers' threads.
+template <typename Queue>
+void Throughput(std::size_t producers, std::size_t consumers, std::size_t batch, std::size_t iterations) {
+  auto queue = MakeQueue<Queue>();
+  auto per_producer = iterations / producers + 1;
+  auto total = per_producer * producers;
+  std::atomic<std::size_t> received{0};
+  tystl::bench::RunThreads(producers + consumers, per_producer, [&](std::size_t index, std::size_t count) {
+    if (index < producers) {
+      Produce(*queue, count, batch);
+    } else {
+      Consume(*queue, received, total, batch);
+    }
+  });
+}
+
+// Spins, then yields, until the queue takes 'value'. MutexQueue has no
+// blocking Push, so the round trip uses this for every queue.
+template <typename Queue>
+void Send(Queue &queue, std::uint64_t value) {
+  tystl::Backoff backoff;
+  while (!queue.TryPush(value)) {
+    backoff.Pause();
+  }
+}
+
+template <typename Queue>
+std::uint64_t Receive(Queue &queue) {
+  tystl::Backoff backoff;
+  std::uint64_t value;
+  while (!queue.TryPop(value)) {
+    backoff.Pause();
+  }
+  return value;
+}
+
+// Bounces one value between two threads through a pair of queues.
+template <typename Queue>
+void RoundTrip(std::size_t iterations) {
+  auto ping = MakeQueue<Queue>();
+  auto pong = MakeQueue<Queue>();
+  tystl::bench::RunThreads(2, iterations, [&](std::size_t index, std::size_t count) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      if (index == 0) {
+        Send(*ping, value);
+        value = Receive(*pong);
+      } else {
+        Send(*pong, Receive(*ping) + 1);
+      }
+    }
+    tystl::bench::DoNotOptimize(value);
+  });
+}
+
+using Spsc = tystl::SpscQueue<std::uint64_t, kCapacity>;
+using Mpmc = tystl::MpmcQueue<std::uint64_t>;
+
+[[maybe_unused]] const bool registered = [] {
+  using tystl::bench::Register;
+
+  for (std::size_t batch : {1, 32}) {
+    auto suffix = "/batch:" + std::to_string(batch);
+    Register("Queue/Throughput/1p1c" + suffix + "/SpscQueue",
+             [=](std::size_t n) { Throughput<Spsc>(1, 1, batch, n); });
+    for (auto [producers, consumers] : {std::pair{1, 1}, {2, 2}, {4, 4}, {1, 4}, {4, 1}}) {
+      auto shape = "/" + std::to_string(producers) + "p" + std::to_string(consumers) + "c";
+      Register("Queue/Throughput" + shape + suffix + "/MpmcQueue",
+               [=](std::size_t n) { Throughput<Mpmc>(producers, consumers, batch, n); });
+      Register("Queue/Throughput" + shape + suffix + "/mutex",
+               [=](std::size_t n) { Throughput<MutexQueue>(producers, consumers, batch, n); });
+    }
+  }
+
+  Register("Queue/RoundTrip/SpscQueue", RoundTrip<Spsc>);
+  Register("Queue/RoundTrip/MpmcQueue", RoundTrip<Mpmc>);
+  Register("Queue/RoundTrip/mutex", RoundTrip<MutexQueue>);
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,71 @@
+// What dropping the last SharedPtr costs the releasing thread, inline and
+// with a ReclaimDomain destroying the object on its background thread.
+// 'release_ns' counts only the final release; the rest of an iteration is
+// building the object.
+
+#include "Bench.hpp"
+#include "Optional.hpp"
+#include "Reclaim.hpp"
+#include "SharedPtr.hpp"
+#include "Vector.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace {
+
+// A snapshot of 'kSnapshotSize' shared strings, too long for SSO.
+constexpr std::size_t kSnapshotSize = 256;
+
+using Snapshot = tystl::Vector<tystl::SharedPtr<std::string>>;
+
+tystl::SharedPtr<Snapshot> MakeSnapshot(std::size_t seed) {
+  auto snapshot = tystl::MakeShared<Snapshot>();
+  for (std::size_t i = 0; i < kSnapshotSize; i ++) {
+    snapshot->push_back(tystl::MakeShared<std::string>(64, static_cast<char>('a' + (seed + i) % 26)));
+  }
+  return snapshot;
+}
+
+template <typename Make>
+void DropLast(tystl::ReclaimDomain *domain, std::size_t iterations, Make make) {
+  using Clock = std::chrono::steady_clock;
+  Clock::duration release{};
+  {
+    tystl::Optional<tystl::ReclaimScope> scope;
+    if (domain != nullptr) {
+      scope.Emplace(*domain);
+    }
+    for (std::size_t i = 0; i < iterations; i ++) {
+      auto object = make(i);
+      tystl::bench::DoNotOptimize(object);
+      auto start = Clock::now();
+      object = nullptr;
+      release += Clock::now() - start;
+    }
+  }
+  tystl::bench::SetCounter("release_ns", static_cast<double>(std::chrono::nanoseconds(release).count()));
+}
+
+tystl::SharedPtr<std::size_t> MakeSmall(std::size_t i) {
+  return tystl::MakeShared<std::size_t>(i);
+}
+
+// Started on first use, so other cases run without its thread.
+tystl::ReclaimDomain* Domain() {
+  static tystl::ReclaimDomain domain;
+  return &domain;
+}
+
+[[maybe_unused]] const bool registered = [] {
+  tystl::bench::Register("Reclaim/DropSnapshot/Inline",
+                         [](std::size_t n) { DropLast(nullptr, n, MakeSnapshot); });
+  tystl::bench::Register("Reclaim/DropSnapshot/Deferred",
+                         [](std::size_t n) { DropLast(Domain(), n, MakeSnapshot); });
+  tystl::bench::Register("Reclaim/DropSmall/Inline", [](std::size_t n) { DropLast(nullptr, n, MakeSmall); });
+  tystl::bench::Register("Reclaim/DropSmall/Deferred", [](std::size_t n) { DropLast(Domain(), n, MakeSmall); });
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Bench.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tystl::bench {
+
+enum class Format { kTable, kCsv, kJson };
+
+struct Options {
+  std::string filter;
+  Format format = Format::kTable;
+  // Where the csv or json results go, standard output if empty.
+  std::string out;
+  // A csv file written by an earlier run to compare against.
+  std::string baseline;
+  // Slowdown in percent past which a case counts as a regression.
+  double threshold = 10.0;
+  std::chrono::milliseconds min_time{100};
+};
+
+inline void PrintUsage(const char *program) {
+  std::fprintf(stderr,
+               "usage: %s [filter] [--format=table|csv|json] [--out=FILE] [--baseline=FILE]\n"
+               "          [--threshold=PERCENT] [--min-time=MS] [--threads=N,N,...] [--max-size=N]\n"
+               "\n"
+               "Runs every case whose name contains 'filter'. With --baseline, compares\n"
+               "ns/op against a csv written by an earlier run and exits with 1 if any\n"
+               "case got slower by more than the threshold (default 10%%). Sized cases\n"
+               "run up to --max-size entries (default 1048576).\n",
+               program);
+}
+
+inline std::vector<std::size_t> ParseList(std::string_view text) {
+  std::vector<std::size_t> values;
+  std::stringstream stream{std::string(text)};
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    values.push_back(std::stoul(item));
+  }
+  return values;
+}
+
+// Returns nothing if the arguments are not understood. '--threads' and
+// '--max-size' update 'ThreadCounts()' and 'MaxSize()' directly.
+inline std::optional<Options> ParseOptions(int argc, char **argv) {
+  Options options;
+  try {
+    for (int i = 1; i < argc; i ++) {
+      std::string_view arg = argv[i];
+      auto value = arg.substr(arg.find('=') + 1);
+      if (!arg.starts_with("--")) {
+        options.filter = arg;
+      } else if (arg.starts_with("--format=")) {
+        if (value == "table") {
+          options.format = Format::kTable;
+        } else if (value == "csv") {
+          options.format = Format::kCsv;
+        } else if (value == "json") {
+          options.format = Format::kJson;
+        } else {
+          return std::nullopt;
+        }
+      } else if (arg.starts_with("--out=")) {
+        options.out = value;
+      } else if (arg.starts_with("--baseline=")) {
+        options.baseline = value;
+      } else if (arg.starts_with("--threshold=")) {
+        options.threshold = std::stod(std::string(value));
+      } else if (arg.starts_with("--min-time=")) {
+        options.min_time = std::chrono::milliseconds(std::stol(std::string(value)));
+      } else if (arg.starts_with("--threads=")) {
+        ThreadCounts() = ParseList(value);
+      } else if (arg.starts_with("--max-size=")) {
+        MaxSize() = std::stoull(std::string(value));
+      } else {
+        return std::nullopt;
+      }
+    }
+  } catch (const std::exception &) {
+    return std::nullopt;
+  }
+  return options;
+}
+
+inline void PrintHeader(std::FILE *file) {
+  std::fprintf(file, "%-56s %14s %14s\n", "benchmark", "ns/op", "iterations");
+}
+
+inline void PrintRow(std::FILE *file, const BenchResult &result) {
+  std::fprintf(file, "%-56s %14.2f %14zu", result.name.c_str(), result.ns_per_op, result.iterations);
+  for (const auto &[counter, value] : result.counters_per_op) {
+    std::fprintf(file, "  %s/op=%.3f", counter.c_str(), value);
+  }
+  std::fprintf(file, "\n");
+  std::fflush(file);
+}
+
+// One row per case: name,ns_per_op,iterations,counters where counters is
+// 'name=value' pairs per iteration joined by ';'.
+inline void WriteCsv(std::FILE *file, const std::vector<BenchResult> &results) {
+  std::fprintf(file, "name,ns_per_op,iterations,counters\n");
+  for (const auto &result : results) {
+    std::fprintf(file, "%s,%.4f,%zu,", result.name.c_str(), result.ns_per_op, result.iterations);
+    for (std::size_t i = 0; i < result.counters_per_op.size(); i ++) {
+      const auto &[counter, value] = result.counters_per_op[i];
+      std::fprintf(file, "%s%s=%.6f", i == 0 ? "" : ";", counter.c_str(), value);
+    }
+    std::fprintf(file, "\n");
+  }
+}
+
+inline void WriteJson(std::FILE *file, const std::vector<BenchResult> &results) {
+  std::fprintf(file, "[\n");
+  for (std::size_t i = 0; i < results.size(); i ++) {
+    const auto &result = results[i];
+    std::fprintf(file, "  {\"name\": \"%s\", \"ns_per_op\": %.4f, \"iterations\": %zu, \"counters\": {",
+                 result.name.c_str(), result.ns_per_op, result.iterations);
+    for (std::size_t k = 0; k < result.counters_per_op.size(); k ++) {
+      const auto &[counter, value] = result.counters_per_op[k];
+      std::fprintf(file, "%s\"%s\": %.6f", k == 0 ? "" : ", ", counter.c_str(), value);
+    }
+    std::fprintf(file, "}}%s\n", i + 1 == results.size() ? "" : ",");
+  }
+  std::fprintf(file, "]\n");
+}
+
+// Reads name -> ns/op from a csv written by 'WriteCsv'.
+inline std::optional<std::map<std::string, double>> ReadBaseline(const std::string &path) {
+  std::ifstream file(path);
+  if (!file) {
+    return std::nullopt;
+  }
+  std::map<std::string, double> baseline;
+  std::string line;
+  std::getline(file, line);
+  while (std::getline(file, line)) {
+    auto first = line.find(',');
+    auto second = line.find(',', first + 1);
+    if (first == std::string::npos || second == std::string::npos) {
+      continue;
+    }
+    baseline[line.substr(0, first)] = std::strtod(line.substr(first + 1, second - first - 1).c_str(), nullptr);
+  }
+  return baseline;
+}
+
+// Prints how every case moved against 'baseline' and returns the number
+// that slowed down by more than 'threshold' percent.
+inline std::size_t CompareBaseline(std::FILE *file, const std::vector<BenchResult> &results,
+                                   const std::map<std::string, double> &baseline, double threshold) {
+  std::size_t regressions = 0;
+  std::fprintf(file, "\n%-56s %14s %14s %9s\n", "benchmark", "base ns/op", "ns/op", "change");
+  for (const auto &result : results) {
+    auto found = baseline.find(result.name);
+    if (found == baseline.end() || found->second <= 0) {
+      std::fprintf(file, "%-56s %14s %14.2f %9s\n", result.name.c_str(), "-", result.ns_per_op, "new");
+      continue;
+    }
+    auto change = (result.ns_per_op / found->second - 1.0) * 100.0;
+    auto regressed = change > threshold;
+    regressions += regressed;
+    std::fprintf(file, "%-56s %14.2f %14.2f %+8.1f%%%s\n", result.name.c_str(), found->second,
+                 result.ns_per_op, change, regressed ? "  REGRESSION" : "");
+  }
+  return regressions;
+}
+
+}
@@ -0,0 +1,113 @@
+#include "Bench.hpp"
+#include "SharedPtr.hpp"
+
+#include <atomic>
+#include <string>
+
+namespace {
+
+// The counting scheme RefCount used before the policies were introduced,
+// kept here as the reference point: seq_cst increments and decrements.
+struct SeqCstRefPolicy {
+  using CountType = std::atomic_size_t;
+
+  static void Increment(CountType &count) noexcept {
+    count ++;
+  }
+
+  static bool Decrement(CountType &count) noexcept {
+    return (-- count) == 0;
+  }
+
+  static bool IncrementIfNonZero(CountType &count) noexcept {
+    auto value = count.load();
+    while (value != 0) {
+      if (count.compare_exchange_weak(value, value + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static std::size_t Load(const CountType &count) noexcept {
+    return count.load();
+  }
+};
+
+struct Payload {
+  int value[4]{};
+};
+
+template <typename Policy>
+void CopyDestroy(std::size_t iterations) {
+  auto ptr = tystl::MakeShared<Payload, Policy>();
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::SharedPtr<Payload, Policy> copy = ptr;
+    tystl::bench::DoNotOptimize(copy);
+  }
+}
+
+template <typename Policy>
+void WeakLock(std::size_t iterations) {
+  auto ptr = tystl::MakeShared<Payload, Policy>();
+  tystl::WeakPtr<Payload, Policy> weak = ptr;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto locked = weak.Lock();
+    tystl::bench::DoNotOptimize(locked);
+  }
+}
+
+template <typename Policy>
+void ContendedCopyDestroy(std::size_t threads, std::size_t iterations) {
+  auto ptr = tystl::MakeShared<Payload, Policy>();
+  tystl::bench::RunThreads(threads, iterations / threads + 1, [&](std::size_t, std::size_t count) {
+    for (std::size_t i = 0; i < count; i ++) {
+      tystl::SharedPtr<Payload, Policy> copy = ptr;
+      tystl::bench::DoNotOptimize(copy);
+    }
+  });
+}
+
+template <typename Policy>
+void MakeSharedDestroy(std::size_t iterations) {
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto ptr = tystl::MakeShared<Payload, Policy>();
+    tystl::bench::DoNotOptimize(ptr);
+  }
+}
+
+template <typename Policy>
+void AdoptPointerDestroy(std::size_t iterations) {
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::SharedPtr<Payload, Policy> ptr(new Payload());
+    tystl::bench::DoNotOptimize(ptr);
+  }
+}
+
+template <typename Policy>
+bool RegisterPolicy(const std::string &policy) {
+  tystl::bench::Register("SharedPtr/CopyDestroy/" + policy, CopyDestroy<Policy>);
+  tystl::bench::Register("SharedPtr/WeakLock/" + policy, WeakLock<Policy>);
+  tystl::bench::Register("SharedPtr/MakeShared/" + policy, MakeSharedDestroy<Policy>);
+  tystl::bench::Register("SharedPtr/AdoptPointer/" + policy, AdoptPointerDestroy<Policy>);
+  return true;
+}
+
+template <typename Policy>
+bool RegisterContended(const std::string &policy) {
+  for (std::size_t threads : {1, 2, 4, 8}) {
+    tystl::bench::Register("SharedPtr/ContendedCopyDestroy/" + policy + "/threads:" + std::to_string(threads),
+                           [threads](std::size_t iterations) {
+                             ContendedCopyDestroy<Policy>(threads, iterations);
+                           });
+  }
+  return true;
+}
+
+[[maybe_unused]] const bool registered = RegisterPolicy<SeqCstRefPolicy>("SeqCst") &&
+                                         RegisterPolicy<tystl::AtomicRefPolicy>("Atomic") &&
+                                         RegisterPolicy<tystl::LocalRefPolicy>("Local") &&
+                                         RegisterContended<SeqCstRefPolicy>("SeqCst") &&
+                                         RegisterContended<tystl::AtomicRefPolicy>("Atomic");
+
+} // namespace
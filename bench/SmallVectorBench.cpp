@@ -0,0 +1,95 @@
+#include "Bench.hpp"
+#include "BinaryHeap.hpp"
+#include "SmallVector.hpp"
+#include "Vector.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+// std::allocator that counts how often it is asked for memory.
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+  T* allocate(std::size_t count) {
+    allocations++;
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T *ptr, std::size_t count) noexcept {
+    std::allocator<T>().deallocate(ptr, count);
+  }
+
+  bool operator==(const CountingAllocator &) const noexcept = default;
+};
+
+using Key = std::uint64_t;
+using Alloc = CountingAllocator<Key>;
+using Less = std::less<Key>;
+
+// A short-lived heap per request: push 'size' keys, pop them all. One
+// iteration is one request.
+template <typename Container>
+void SmallHeap(std::size_t size, std::size_t iterations) {
+  std::mt19937_64 rng(99);
+  allocations = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::BinaryHeap<Key, Less, Container> heap;
+    for (std::size_t k = 0; k < size; k ++) {
+      heap.Push(rng());
+    }
+    while (!heap.Empty()) {
+      tystl::bench::DoNotOptimize(heap.Top());
+      heap.Pop();
+    }
+  }
+  tystl::bench::SetCounter("allocs", static_cast<double>(allocations));
+}
+
+// Builds a short list and moves it on, as when handing it to another stage.
+template <typename Container>
+void ListMove(std::size_t size, std::size_t iterations) {
+  allocations = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Container list;
+    for (std::size_t k = 0; k < size; k ++) {
+      list.push_back(k);
+    }
+    Container moved = std::move(list);
+    tystl::bench::DoNotOptimize(moved);
+  }
+  tystl::bench::SetCounter("allocs", static_cast<double>(allocations));
+}
+
+template <std::size_t Size>
+bool RegisterSize() {
+  auto suffix = "/size:" + std::to_string(Size);
+  tystl::bench::Register("SmallVector/SmallHeap/std::vector" + suffix,
+                         [](std::size_t n) { SmallHeap<std::vector<Key, Alloc>>(Size, n); });
+  tystl::bench::Register("SmallVector/SmallHeap/Vector" + suffix,
+                         [](std::size_t n) { SmallHeap<tystl::Vector<Key, Alloc>>(Size, n); });
+  tystl::bench::Register("SmallVector/SmallHeap/SmallVector<16>" + suffix,
+                         [](std::size_t n) { SmallHeap<tystl::SmallVector<Key, 16, Alloc>>(Size, n); });
+  tystl::bench::Register("SmallVector/ListMove/std::vector" + suffix,
+                         [](std::size_t n) { ListMove<std::vector<Key, Alloc>>(Size, n); });
+  tystl::bench::Register("SmallVector/ListMove/SmallVector<16>" + suffix,
+                         [](std::size_t n) { ListMove<tystl::SmallVector<Key, 16, Alloc>>(Size, n); });
+  return true;
+}
+
+[[maybe_unused]] const bool registered = RegisterSize<4>() && RegisterSize<16>() && RegisterSize<64>();
+
+} // namespace
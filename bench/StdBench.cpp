@@ -0,0 +1,264 @@
+// Every tystl type next to its std counterpart, under the same workload.
+// Case names read 'Type/Operation/.../tystl' and '.../std' so a filter on
+// the type shows both.
+
+#include "Any.hpp"
+#include "Array.hpp"
+#include "Bench.hpp"
+#include "BinaryHeap.hpp"
+#include "Optional.hpp"
+#include "SharedPtr.hpp"
+#include "UniquePtr.hpp"
+
+#include <any>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t kSeed = 20240601;
+
+struct Payload {
+  std::uint64_t value[4]{};
+};
+
+// Smart pointers: 'Make' builds one, the cases copy, move and destroy it.
+
+struct TyShared {
+  static auto Make() { return tystl::MakeShared<Payload>(); }
+};
+
+struct StdShared {
+  static auto Make() { return std::make_shared<Payload>(); }
+};
+
+struct TyUnique {
+  static auto Make() { return tystl::MakeUnique<Payload>(); }
+};
+
+struct StdUnique {
+  static auto Make() { return std::make_unique<Payload>(); }
+};
+
+template <typename Ptr>
+void MakeDestroy(std::size_t iterations) {
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto ptr = Ptr::Make();
+    tystl::bench::DoNotOptimize(ptr);
+  }
+}
+
+template <typename Ptr>
+void CopyDestroy(std::size_t iterations) {
+  auto ptr = Ptr::Make();
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto copy = ptr;
+    tystl::bench::DoNotOptimize(copy);
+  }
+}
+
+// Moves the pointer back and forth between two handles.
+template <typename Ptr>
+void Move(std::size_t iterations) {
+  auto first = Ptr::Make();
+  decltype(first) second;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    second = std::move(first);
+    tystl::bench::DoNotOptimize(second);
+    first = std::move(second);
+    tystl::bench::DoNotOptimize(first);
+  }
+}
+
+template <typename Ptr>
+void ContendedCopy(std::size_t threads, std::size_t iterations) {
+  auto ptr = Ptr::Make();
+  tystl::bench::RunThreads(threads, iterations / threads + 1, [&](std::size_t, std::size_t count) {
+    for (std::size_t i = 0; i < count; i ++) {
+      auto copy = ptr;
+      tystl::bench::DoNotOptimize(copy);
+    }
+  });
+}
+
+// Optional: copies of a small and a non-trivial value, and ValueOr on a mix
+// of engaged and empty ones.
+
+template <template <typename> typename Opt, typename T>
+void OptionalCopy(const T &value, std::size_t iterations) {
+  Opt<T> source = value;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Opt<T> copy = source;
+    tystl::bench::DoNotOptimize(copy);
+  }
+}
+
+template <template <typename> typename Opt>
+void OptionalValueOr(std::size_t iterations) {
+  std::mt19937_64 rng(kSeed);
+  std::vector<Opt<std::uint64_t>> values(1024);
+  for (auto &value : values) {
+    if (rng() % 2 == 0) {
+      value = rng();
+    }
+  }
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    if constexpr (requires { values[0].ValueOr(0); }) {
+      sum += values[i % values.size()].ValueOr(0);
+    } else {
+      sum += values[i % values.size()].value_or(0);
+    }
+  }
+  tystl::bench::DoNotOptimize(sum);
+}
+
+// Any: construction, copies and checked casts.
+
+struct Large {
+  std::uint64_t value[8]{};
+};
+
+template <typename AnyType, typename T>
+void AnyConstruct(std::size_t iterations) {
+  for (std::size_t i = 0; i < iterations; i ++) {
+    AnyType any = T{};
+    tystl::bench::DoNotOptimize(any);
+  }
+}
+
+template <typename AnyType, typename T>
+void AnyCopy(std::size_t iterations) {
+  AnyType source = T{};
+  for (std::size_t i = 0; i < iterations; i ++) {
+    AnyType copy = source;
+    tystl::bench::DoNotOptimize(copy);
+  }
+}
+
+template <typename AnyType>
+void AnyCast(std::size_t iterations) {
+  AnyType any = std::uint64_t{42};
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(any);
+    if constexpr (std::is_same_v<AnyType, std::any>) {
+      sum += *std::any_cast<std::uint64_t>(&any);
+    } else {
+      sum += *any.template Cast<std::uint64_t>();
+    }
+  }
+  tystl::bench::DoNotOptimize(sum);
+}
+
+// Array: comparisons of two arrays that differ only in the last element.
+
+template <typename ArrayType>
+void ArrayCompare(std::size_t iterations) {
+  std::mt19937_64 rng(kSeed);
+  ArrayType left;
+  for (auto &value : left) {
+    value = static_cast<typename ArrayType::value_type>(rng());
+  }
+  auto right = left;
+  right[right.size() - 1] += 1;
+  std::size_t less = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(left);
+    less += (left <=> right) < 0;
+    less += left == right;
+  }
+  tystl::bench::DoNotOptimize(less);
+}
+
+// BinaryHeap against std::priority_queue: one push and one pop per
+// iteration on a heap of 'size' keys.
+
+struct TyHeap {
+  tystl::BinaryHeap<std::uint64_t, std::greater<std::uint64_t>> heap;
+  void Push(std::uint64_t key) { heap.Push(key); }
+  void Pop() { heap.Pop(); }
+};
+
+struct StdHeap {
+  std::priority_queue<std::uint64_t> heap;
+  void Push(std::uint64_t key) { heap.push(key); }
+  void Pop() { heap.pop(); }
+};
+
+template <typename Heap>
+void HeapPushPop(std::size_t size, std::size_t iterations) {
+  std::mt19937_64 rng(kSeed);
+  Heap heap;
+  for (std::size_t i = 0; i < size; i ++) {
+    heap.Push(rng());
+  }
+  for (std::size_t i = 0; i < iterations; i ++) {
+    heap.Push(rng());
+    heap.Pop();
+  }
+  tystl::bench::DoNotOptimize(heap);
+}
+
+template <std::size_t N>
+void RegisterArray(const std::string &element_size) {
+  tystl::bench::Register("Array/Compare/u8/bytes:" + element_size + "/tystl", ArrayCompare<tystl::Array<std::uint8_t, N>>);
+  tystl::bench::Register("Array/Compare/u8/bytes:" + element_size + "/std", ArrayCompare<std::array<std::uint8_t, N>>);
+}
+
+[[maybe_unused]] const bool registered = [] {
+  using tystl::bench::Register;
+  using tystl::bench::RegisterThreaded;
+
+  Register("SharedPtr/MakeDestroy/tystl", MakeDestroy<TyShared>);
+  Register("SharedPtr/MakeDestroy/std", MakeDestroy<StdShared>);
+  Register("SharedPtr/CopyDestroy/tystl", CopyDestroy<TyShared>);
+  Register("SharedPtr/CopyDestroy/std", CopyDestroy<StdShared>);
+  Register("SharedPtr/Move/tystl", Move<TyShared>);
+  Register("SharedPtr/Move/std", Move<StdShared>);
+  RegisterThreaded("SharedPtr/ContendedCopy/tystl", ContendedCopy<TyShared>);
+  RegisterThreaded("SharedPtr/ContendedCopy/std", ContendedCopy<StdShared>);
+
+  Register("UniquePtr/MakeDestroy/tystl", MakeDestroy<TyUnique>);
+  Register("UniquePtr/MakeDestroy/std", MakeDestroy<StdUnique>);
+  Register("UniquePtr/Move/tystl", Move<TyUnique>);
+  Register("UniquePtr/Move/std", Move<StdUnique>);
+
+  Register("Optional/Copy/u64/tystl", [](std::size_t n) { OptionalCopy<tystl::Optional>(std::uint64_t{7}, n); });
+  Register("Optional/Copy/u64/std", [](std::size_t n) { OptionalCopy<std::optional>(std::uint64_t{7}, n); });
+  Register("Optional/Copy/string/tystl", [](std::size_t n) { OptionalCopy<tystl::Optional>(std::string(32, 'x'), n); });
+  Register("Optional/Copy/string/std", [](std::size_t n) { OptionalCopy<std::optional>(std::string(32, 'x'), n); });
+  Register("Optional/ValueOr/tystl", OptionalValueOr<tystl::Optional>);
+  Register("Optional/ValueOr/std", OptionalValueOr<std::optional>);
+
+  Register("Any/Construct/u64/tystl", AnyConstruct<tystl::Any, std::uint64_t>);
+  Register("Any/Construct/u64/std", AnyConstruct<std::any, std::uint64_t>);
+  Register("Any/Construct/Large/tystl", AnyConstruct<tystl::Any, Large>);
+  Register("Any/Construct/Large/std", AnyConstruct<std::any, Large>);
+  Register("Any/CopyDestroy/u64/tystl", AnyCopy<tystl::Any, std::uint64_t>);
+  Register("Any/CopyDestroy/u64/std", AnyCopy<std::any, std::uint64_t>);
+  Register("Any/CopyDestroy/Large/tystl", AnyCopy<tystl::Any, Large>);
+  Register("Any/CopyDestroy/Large/std", AnyCopy<std::any, Large>);
+  Register("Any/Cast/tystl", AnyCast<tystl::Any>);
+  Register("Any/Cast/std", AnyCast<std::any>);
+
+  RegisterArray<16>("16");
+  RegisterArray<256>("256");
+  RegisterArray<4096>("4096");
+
+  for (std::size_t size : {std::size_t{64}, std::size_t{4096}, std::size_t{1} << 16}) {
+    auto suffix = "/size:" + std::to_string(size);
+    Register("BinaryHeap/PushPop" + suffix + "/tystl", [=](std::size_t n) { HeapPushPop<TyHeap>(size, n); });
+    Register("BinaryHeap/PushPop" + suffix + "/std", [=](std::size_t n) { HeapPushPop<StdHeap>(size, n); });
+  }
+  return true;
+}();
+
+} // namespace
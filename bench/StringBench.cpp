@@ -0,0 +1,184 @@
+// String and StringView against std::string and std::string_view. Both
+// strings keep short values inline: libstdc++ up to 15 characters, String
+// up to 23. 'allocs' counts the allocations of a whole run.
+
+#include "Bench.hpp"
+#include "String.hpp"
+#include "StringView.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+
+std::size_t allocations = 0;
+
+// std::allocator that counts how often it is asked for memory.
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+  T* allocate(std::size_t count) {
+    allocations++;
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T *ptr, std::size_t count) noexcept {
+    std::allocator<T>().deallocate(ptr, count);
+  }
+
+  bool operator==(const CountingAllocator &) const noexcept = default;
+};
+
+using StdString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+using TyString = tystl::BasicString<CountingAllocator<char>>;
+
+// Characters that differ along the string, so comparisons read all of it.
+std::string Text(std::size_t length) {
+  std::string text(length, ' ');
+  for (std::size_t i = 0; i < length; i ++) {
+    text[i] = static_cast<char>('a' + i * 7 % 26);
+  }
+  return text;
+}
+
+void ReportAllocations() {
+  tystl::bench::SetCounter("allocs", static_cast<double>(allocations));
+}
+
+// One iteration builds a string of 'Length' characters and drops it.
+template <typename Str, std::size_t Length>
+void Construct(std::size_t iterations) {
+  auto text = Text(Length);
+  allocations = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Str str(text.data(), text.size());
+    tystl::bench::DoNotOptimize(str);
+  }
+  ReportAllocations();
+}
+
+// One iteration copies a string of 'Length' characters.
+template <typename Str, std::size_t Length>
+void Copy(std::size_t iterations) {
+  auto text = Text(Length);
+  Str source(text.data(), text.size());
+  allocations = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(source);
+    Str copy = source;
+    tystl::bench::DoNotOptimize(copy);
+  }
+  ReportAllocations();
+}
+
+// One iteration builds a string of 'Length' characters from 8 character
+// pieces, as a log line is put together field by field.
+template <typename Str, std::size_t Length>
+void Append(std::size_t iterations) {
+  auto piece = Text(8);
+  allocations = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Str str;
+    for (std::size_t size = 0; size < Length; size += piece.size()) {
+      str.append(piece.data(), piece.size());
+    }
+    tystl::bench::DoNotOptimize(str);
+  }
+  ReportAllocations();
+}
+
+template <std::size_t Length>
+void AppendString(std::size_t iterations) {
+  auto piece = Text(8);
+  allocations = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    TyString str;
+    for (std::size_t size = 0; size < Length; size += piece.size()) {
+      str.Append(piece);
+    }
+    tystl::bench::DoNotOptimize(str);
+  }
+  ReportAllocations();
+}
+
+// One iteration compares two equal strings of 'Length' characters.
+template <typename Str, std::size_t Length>
+void Compare(std::size_t iterations) {
+  auto text = Text(Length);
+  Str left(text.data(), text.size());
+  Str right(text.data(), text.size());
+  std::size_t equal = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(left);
+    equal += left == right;
+  }
+  tystl::bench::DoNotOptimize(equal);
+}
+
+// One iteration finds a 6 character needle at the end of 'Length'
+// characters whose text often matches the needle's first character.
+template <typename View, std::size_t Length>
+void Find(std::size_t iterations) {
+  std::string text(Length, 'a');
+  for (std::size_t i = 0; i < Length; i += 3) {
+    text[i] = 'x';
+  }
+  text.replace(Length - 6, 6, "xyzzyx");
+  View haystack(text.data(), text.size());
+  View needle("xyzzyx");
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    tystl::bench::DoNotOptimize(haystack);
+    if constexpr (std::is_same_v<View, std::string_view>) {
+      total += haystack.find(needle);
+    } else {
+      total += haystack.Find(needle);
+    }
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+template <std::size_t Length>
+bool RegisterLength(const char *length) {
+  using tystl::bench::Register;
+  auto suffix = std::string("/") + length + "/";
+  Register("String/Construct" + suffix + "std::string", Construct<StdString, Length>);
+  Register("String/Construct" + suffix + "String", Construct<TyString, Length>);
+  Register("String/Copy" + suffix + "std::string", Copy<StdString, Length>);
+  Register("String/Copy" + suffix + "String", Copy<TyString, Length>);
+  Register("String/Append" + suffix + "std::string", Append<StdString, Length>);
+  Register("String/Append" + suffix + "String", AppendString<Length>);
+  Register("String/Compare" + suffix + "std::string", Compare<StdString, Length>);
+  Register("String/Compare" + suffix + "String", Compare<TyString, Length>);
+  return true;
+}
+
+template <std::size_t Length>
+bool RegisterFind(const char *length) {
+  using tystl::bench::Register;
+  auto suffix = std::string("/") + length + "/";
+  Register("StringView/Find" + suffix + "std::string_view", Find<std::string_view, Length>);
+  Register("StringView/Find" + suffix + "StringView", Find<tystl::StringView, Length>);
+  return true;
+}
+
+[[maybe_unused]] const bool registered =
+  RegisterLength<8>("len:8") &&
+  RegisterLength<16>("len:16") &&
+  RegisterLength<23>("len:23") &&
+  RegisterLength<64>("len:64") &&
+  RegisterLength<512>("len:512") &&
+  RegisterFind<64>("len:64") &&
+  RegisterFind<1024>("len:1024") &&
+  RegisterFind<16384>("len:16384");
+
+} // namespace
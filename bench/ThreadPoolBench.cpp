@@ -0,0 +1,216 @@
+// ThreadPool against the usual pool: one std::deque of std::function behind
+// a mutex and a condition variable. Pools are built once per thread count,
+// outside the timed region.
+
+#include "Bench.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+class MutexPool {
+public:
+  explicit MutexPool(std::size_t threads) {
+    for (std::size_t i = 0; i < threads; i ++) {
+      workers_.emplace_back([this] { this->Loop(); });
+    }
+  }
+
+  ~MutexPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    ready_.notify_all();
+  }
+
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard lock(mutex_);
+      queue_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+  }
+
+private:
+  void Loop() {
+    while (true) {
+      std::unique_lock lock(mutex_);
+      ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      auto task = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+      task();
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::function<void()>> queue_;
+  bool stop_ = false;
+  std::vector<std::jthread> workers_;
+};
+
+template <typename Pool>
+Pool& PoolOf(std::size_t threads) {
+  static std::map<std::size_t, std::unique_ptr<Pool>> pools;
+  auto &pool = pools[threads];
+  if (!pool) {
+    pool = std::make_unique<Pool>(threads);
+  }
+  return *pool;
+}
+
+template <typename Pool, typename F>
+void Spawn(Pool &pool, F &&func) {
+  if constexpr (requires { pool.Submit(std::forward<F>(func)).Get(); }) {
+    // Dropping the future leaves the task running.
+    (void)pool.Submit(std::forward<F>(func));
+  } else {
+    pool.Submit(std::forward<F>(func));
+  }
+}
+
+void WaitFor(const std::atomic<std::size_t> &counter, std::size_t target) {
+  while (counter.load(std::memory_order_acquire) < target) {
+    std::this_thread::yield();
+  }
+}
+
+// A few nanoseconds of work that the compiler cannot drop.
+std::uint64_t Work(std::uint64_t index) {
+  auto x = index * 0x9E3779B97F4A7C15ULL + 1;
+  for (int i = 0; i < 8; i ++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  return x;
+}
+
+// One iteration is one empty task submitted from outside the pool.
+template <typename Pool>
+void SubmitOutside(std::size_t threads, std::size_t iterations) {
+  auto &pool = PoolOf<Pool>(threads);
+  std::atomic<std::size_t> done{0};
+  for (std::size_t i = 0; i < iterations; i ++) {
+    Spawn(pool, [&done] { done.fetch_add(1, std::memory_order_release); });
+  }
+  WaitFor(done, iterations);
+}
+
+// One iteration is one task of a binary tree of tasks that spawn their
+// children from inside the pool.
+template <typename Pool>
+void SpawnTree(Pool &pool, std::atomic<std::size_t> &done, std::size_t tasks) {
+  auto children = tasks - 1;
+  if (children != 0) {
+    auto left = children / 2;
+    if (left != 0) {
+      Spawn(pool, [&pool, &done, left] { SpawnTree(pool, done, left); });
+    }
+    Spawn(pool, [&pool, &done, right = children - left] { SpawnTree(pool, done, right); });
+  }
+  done.fetch_add(1, std::memory_order_release);
+}
+
+template <typename Pool>
+void SpawnTreeCase(std::size_t threads, std::size_t iterations) {
+  auto &pool = PoolOf<Pool>(threads);
+  std::atomic<std::size_t> done{0};
+  Spawn(pool, [&pool, &done, iterations] { SpawnTree(pool, done, iterations); });
+  WaitFor(done, iterations);
+}
+
+constexpr std::size_t kGrain = 256;
+
+// One iteration is one index of a parallel loop. The mutex pool gets the
+// loop cut into grain sized tasks up front.
+void ForWorkStealing(std::size_t threads, std::size_t iterations) {
+  auto &pool = PoolOf<tystl::ThreadPool>(threads);
+  pool.ParallelFor(0, iterations, kGrain, [](std::size_t lo, std::size_t hi) {
+    std::uint64_t sum = 0;
+    for (auto i = lo; i < hi; i ++) {
+      sum += Work(i);
+    }
+    tystl::bench::DoNotOptimize(sum);
+  });
+}
+
+void ForMutex(std::size_t threads, std::size_t iterations) {
+  auto &pool = PoolOf<MutexPool>(threads);
+  std::atomic<std::size_t> done{0};
+  std::size_t chunks = 0;
+  for (std::size_t lo = 0; lo < iterations; lo += kGrain, chunks ++) {
+    auto hi = lo + kGrain < iterations ? lo + kGrain : iterations;
+    pool.Submit([&done, lo, hi] {
+      std::uint64_t sum = 0;
+      for (auto i = lo; i < hi; i ++) {
+        sum += Work(i);
+      }
+      tystl::bench::DoNotOptimize(sum);
+      done.fetch_add(1, std::memory_order_release);
+    });
+  }
+  WaitFor(done, chunks);
+}
+
+// One iteration is one index of a parallel sum.
+void ReduceWorkStealing(std::size_t threads, std::size_t iterations) {
+  auto &pool = PoolOf<tystl::ThreadPool>(threads);
+  auto sum = pool.ParallelReduce(
+    0, iterations, kGrain, std::uint64_t{0},
+    [](std::size_t lo, std::size_t hi, std::uint64_t acc) {
+      for (auto i = lo; i < hi; i ++) {
+        acc += Work(i);
+      }
+      return acc;
+    },
+    [](std::uint64_t left, std::uint64_t right) { return left + right; });
+  tystl::bench::DoNotOptimize(sum);
+}
+
+[[maybe_unused]] const bool registered = [] {
+  for (std::size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+    auto suffix = "/threads:" + std::to_string(threads);
+    tystl::bench::Register("ThreadPool/Submit/Mutex" + suffix, [threads](std::size_t iterations) {
+      SubmitOutside<MutexPool>(threads, iterations);
+    });
+    tystl::bench::Register("ThreadPool/Submit/WorkStealing" + suffix, [threads](std::size_t iterations) {
+      SubmitOutside<tystl::ThreadPool>(threads, iterations);
+    });
+    tystl::bench::Register("ThreadPool/SpawnTree/Mutex" + suffix, [threads](std::size_t iterations) {
+      SpawnTreeCase<MutexPool>(threads, iterations);
+    });
+    tystl::bench::Register("ThreadPool/SpawnTree/WorkStealing" + suffix, [threads](std::size_t iterations) {
+      SpawnTreeCase<tystl::ThreadPool>(threads, iterations);
+    });
+    tystl::bench::Register("ThreadPool/ParallelFor/Mutex" + suffix, [threads](std::size_t iterations) {
+      ForMutex(threads, iterations);
+    });
+    tystl::bench::Register("ThreadPool/ParallelFor/WorkStealing" + suffix, [threads](std::size_t iterations) {
+      ForWorkStealing(threads, iterations);
+    });
+    tystl::bench::Register("ThreadPool/ParallelReduce/WorkStealing" + suffix, [threads](std::size_t iterations) {
+      ReduceWorkStealing(threads, iterations);
+    });
+  }
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,156 @@
+// Variant against std::variant and Any. Variant and std::variant dispatch
+// through a jump table; Any has no visitation, so the Any cases test the
+// alternatives one after another with 'Cast', as code built on it does.
+
+#include "Any.hpp"
+#include "Bench.hpp"
+#include "Variant.hpp"
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+struct Circle {
+  double radius;
+};
+
+struct Rect {
+  double width;
+  double height;
+};
+
+struct Triangle {
+  double base;
+  double height;
+};
+
+struct Square {
+  double side;
+};
+
+double Area(const Circle &shape) { return 3.0 * shape.radius * shape.radius; }
+
+double Area(const Rect &shape) { return shape.width * shape.height; }
+
+double Area(const Triangle &shape) { return shape.base * shape.height / 2; }
+
+double Area(const Square &shape) { return shape.side * shape.side; }
+
+constexpr std::size_t kShapeCount = 4096;
+
+template <typename Shape>
+std::vector<Shape> MakeShapes() {
+  std::vector<Shape> shapes;
+  shapes.reserve(kShapeCount);
+  std::uint64_t state = 1;
+  for (std::size_t i = 0; i < kShapeCount; i ++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    auto size = static_cast<double>(i % 7 + 1);
+    switch (state >> 62) {
+      case 0: shapes.emplace_back(Circle{size}); break;
+      case 1: shapes.emplace_back(Rect{size, size + 1}); break;
+      case 2: shapes.emplace_back(Triangle{size, size + 2}); break;
+      default: shapes.emplace_back(Square{size}); break;
+    }
+  }
+  return shapes;
+}
+
+double AreaOf(const tystl::Variant<Circle, Rect, Triangle, Square> &shape) {
+  return tystl::Visit([](const auto &value) { return Area(value); }, shape);
+}
+
+double AreaOf(const std::variant<Circle, Rect, Triangle, Square> &shape) {
+  return std::visit([](const auto &value) { return Area(value); }, shape);
+}
+
+double AreaOf(const tystl::Any &shape) {
+  if (auto *circle = shape.Cast<Circle>()) {
+    return Area(*circle);
+  }
+  if (auto *rect = shape.Cast<Rect>()) {
+    return Area(*rect);
+  }
+  if (auto *triangle = shape.Cast<Triangle>()) {
+    return Area(*triangle);
+  }
+  return Area(*shape.Cast<Square>());
+}
+
+// One iteration visits one shape of a shuffled list, so the branch on the
+// alternative is not predictable.
+template <typename Shape>
+void Visit(std::size_t iterations) {
+  auto shapes = MakeShapes<Shape>();
+  double total = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    total += AreaOf(shapes[i % kShapeCount]);
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+// Whether two shapes could overlap, decided per pair of alternatives.
+struct Overlaps {
+  template <typename L, typename R>
+  bool operator()(const L &left, const R &right) const {
+    return Area(left) + Area(right) > 40;
+  }
+};
+
+// One iteration visits two shapes at once, sixteen combinations.
+template <typename Shape>
+void VisitPair(std::size_t iterations) {
+  auto shapes = MakeShapes<Shape>();
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    const auto &left = shapes[i % kShapeCount];
+    const auto &right = shapes[(i * 7 + 3) % kShapeCount];
+    if constexpr (tystl::variant_detail::kIsVariant<Shape>) {
+      total += tystl::Visit(Overlaps(), left, right);
+    } else {
+      total += std::visit(Overlaps(), left, right);
+    }
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+// One iteration copies a list of 64 values, half of them strings too long
+// for SSO.
+template <typename Value>
+void Copy(std::size_t iterations) {
+  std::vector<Value> values;
+  for (std::size_t i = 0; i < 64; i ++) {
+    if (i % 2 == 0) {
+      values.emplace_back(static_cast<std::int64_t>(i));
+    } else {
+      values.emplace_back(std::string(32, 'a'));
+    }
+  }
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < iterations; i ++) {
+    auto copy = values;
+    tystl::bench::DoNotOptimize(copy);
+    total += copy.size();
+  }
+  tystl::bench::DoNotOptimize(total);
+}
+
+using TyShape = tystl::Variant<Circle, Rect, Triangle, Square>;
+using StdShape = std::variant<Circle, Rect, Triangle, Square>;
+
+[[maybe_unused]] const bool registered = [] {
+  tystl::bench::Register("Variant/Visit/Variant", Visit<TyShape>);
+  tystl::bench::Register("Variant/Visit/std::variant", Visit<StdShape>);
+  tystl::bench::Register("Variant/Visit/Any", Visit<tystl::Any>);
+  tystl::bench::Register("Variant/VisitPair/Variant", VisitPair<TyShape>);
+  tystl::bench::Register("Variant/VisitPair/std::variant", VisitPair<StdShape>);
+  tystl::bench::Register("Variant/Copy/Variant", Copy<tystl::Variant<std::int64_t, std::string>>);
+  tystl::bench::Register("Variant/Copy/std::variant", Copy<std::variant<std::int64_t, std::string>>);
+  tystl::bench::Register("Variant/Copy/Any", Copy<tystl::Any>);
+  return true;
+}();
+
+} // namespace
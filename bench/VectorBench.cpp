@@ -0,0 +1,93 @@
+#include "Bench.hpp"
+#include "BinaryHeap.hpp"
+#include "SharedPtr.hpp"
+#include "UniquePtr.hpp"
+#include "Vector.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Container, typename Make>
+void Grow(std::size_t size, Make make, std::size_t iterations) {
+  for (std::size_t done = 0; done < iterations; done += size) {
+    Container cont;
+    for (std::size_t i = 0; i < size; i ++) {
+      cont.emplace_back(make(i));
+    }
+    tystl::bench::DoNotOptimize(cont);
+  }
+}
+
+// Inserts at and erases from the front, so every call shifts the whole
+// Vector by one slot.
+template <typename Container, typename Make>
+void ShiftFront(std::size_t size, Make make, std::size_t iterations) {
+  Container cont;
+  for (std::size_t i = 0; i < size; i ++) {
+    cont.emplace_back(make(i));
+  }
+  for (std::size_t i = 0; i < iterations; i ++) {
+    cont.insert(cont.begin(), make(i));
+    cont.erase(cont.begin() + 1);
+  }
+  tystl::bench::DoNotOptimize(cont);
+}
+
+// Wraps Vector's insert and erase in the std spelling ShiftFront expects.
+template <typename T>
+struct TyVector : tystl::Vector<T> {
+  auto insert(const T *pos, T &&value) { return this->Insert(pos, tystl::Move(value)); }
+  auto erase(const T *pos) { return this->Erase(pos); }
+};
+
+template <typename Heap>
+void HeapFill(std::size_t size, std::size_t iterations) {
+  std::mt19937_64 rng(7);
+  for (std::size_t done = 0; done < iterations; done += size) {
+    Heap heap;
+    for (std::size_t i = 0; i < size; i ++) {
+      heap.Push(rng());
+    }
+    tystl::bench::DoNotOptimize(heap.Top());
+  }
+}
+
+auto MakeUnique = [](std::size_t i) { return tystl::UniquePtr<std::size_t>(new std::size_t(i)); };
+auto MakeShared = [](std::size_t i) { return tystl::MakeShared<std::size_t>(i); };
+auto MakeString = [](std::size_t i) { return std::string(24, static_cast<char>('a' + i % 26)); };
+
+template <typename T, typename Make>
+void RegisterElement(const std::string &element, Make make) {
+  for (std::size_t size : {std::size_t{64}, std::size_t{4096}}) {
+    auto suffix = "/" + element + "/size:" + std::to_string(size);
+    tystl::bench::Register("Vector/Grow/std" + suffix, [=](std::size_t n) { Grow<std::vector<T>>(size, make, n); });
+    tystl::bench::Register("Vector/Grow/tystl" + suffix, [=](std::size_t n) { Grow<tystl::Vector<T>>(size, make, n); });
+    tystl::bench::Register("Vector/ShiftFront/std" + suffix,
+                           [=](std::size_t n) { ShiftFront<std::vector<T>>(size, make, n); });
+    tystl::bench::Register("Vector/ShiftFront/tystl" + suffix,
+                           [=](std::size_t n) { ShiftFront<TyVector<T>>(size, make, n); });
+  }
+}
+
+[[maybe_unused]] const bool registered = [] {
+  RegisterElement<tystl::UniquePtr<std::size_t>>("UniquePtr", MakeUnique);
+  RegisterElement<tystl::SharedPtr<std::size_t>>("SharedPtr", MakeShared);
+  RegisterElement<std::string>("string", MakeString);
+
+  using Less = std::less<std::uint64_t>;
+  tystl::bench::Register("Vector/HeapFill/std/size:4096", [](std::size_t n) {
+    HeapFill<tystl::BinaryHeap<std::uint64_t, Less, std::vector<std::uint64_t>>>(4096, n);
+  });
+  tystl::bench::Register("Vector/HeapFill/tystl/size:4096", [](std::size_t n) {
+    HeapFill<tystl::BinaryHeap<std::uint64_t, Less>>(4096, n);
+  });
+  return true;
+}();
+
+} // namespace
@@ -1,99 +1,212 @@
 #pragma once
 
+#include "Concept.hpp"
+#include "Instrument.hpp"
+#include "Pool.hpp"
 #include "Utility.hpp"
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 namespace tystl {
 
+  // Holds a value of any copyable type.
+  //
+  // Values of at most 'kInlineSize' bytes, aligned to at most 'kInlineAlign',
+  // whose move constructor cannot throw are stored inside the Any (see
+  // 'IsInline'); everything else lives in a block from the thread-caching
+  // Pool. Moving an Any that holds an inline value moves the value and
+  // never allocates.
+  //
+  // The stored type is identified by the address of its operations table, so
+  // neither RTTI nor virtual dispatch is involved and the header builds with
+  // '-fno-rtti'.
   class Any {
-  private:
-    struct Base {
-      constexpr virtual ~Base() noexcept = default;
+  public:
+    static constexpr std::size_t kInlineSize = 3 * sizeof(void*);
 
-      constexpr virtual std::unique_ptr<Base> Clone() = 0;
-    };
+    static constexpr std::size_t kInlineAlign = alignof(void*);
 
     template <typename T>
-    struct Derive : Base {
-      constexpr Derive(const T &value) : elem_(value) {}      
+    static constexpr bool IsInline = sizeof(T) <= kInlineSize
+                                  && alignof(T) <= kInlineAlign
+                                  && std::is_nothrow_move_constructible_v<T>;
+
+  private:
+    // One table per stored type, its address doubles as the type tag.
+    struct Operations {
+      void (*destroy)(Any &self) noexcept;
+      void (*copy)(const Any &from, Any &to);
+      void (*move)(Any &from, Any &to) noexcept;
+    };
 
+    template <typename T>
+    struct Handler {
       [[nodiscard]]
-      constexpr std::unique_ptr<Base> Clone() override {
-        return std::make_unique<Derive>(elem_);
+      static T* Get(const Any &self) noexcept {
+        if constexpr (IsInline<T>) {
+          return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(self.storage_.buffer)));
+        } else {
+          return static_cast<T*>(self.storage_.heap);
+        }
       }
 
       template <typename ...Args>
         requires requires (Args ...args) { T(args...); }
-      [[nodiscard]]
-      static constexpr std::unique_ptr<Base> MakeData(Args &&...args) {
-        return std::make_unique<Derive>(std::forward<Args>(args)...);
+      static void MakeData(Any &self, Args &&...args) {
+        if constexpr (IsInline<T>) {
+          ::new (static_cast<void*>(self.storage_.buffer)) T(tystl::Forward<Args>(args)...);
+        } else {
+          void *ptr = Pool::Allocate(sizeof(T), alignof(T));
+          instrument::CountAllocation<T>(sizeof(T));
+          try {
+            self.storage_.heap = ::new (ptr) T(tystl::Forward<Args>(args)...);
+          } catch (...) {
+            Pool::Deallocate(ptr, sizeof(T), alignof(T));
+            throw;
+          }
+        }
+        self.operations_ = &kOperations;
+      }
+
+      static void Destroy(Any &self) noexcept {
+        std::destroy_at(Get(self));
+        if constexpr (!IsInline<T>) {
+          Pool::Deallocate(self.storage_.heap, sizeof(T), alignof(T));
+        }
       }
 
-      T elem_;
+      static void Copy(const Any &from, Any &to) {
+        MakeData(to, *Get(from));
+      }
+
+      static void Move(Any &from, Any &to) noexcept {
+        if constexpr (IsInline<T>) {
+          ::new (static_cast<void*>(to.storage_.buffer)) T(tystl::Move(*Get(from)));
+          std::destroy_at(Get(from));
+        } else {
+          to.storage_.heap = from.storage_.heap;
+        }
+        to.operations_ = &kOperations;
+      }
+
+      static constexpr Operations kOperations{&Destroy, &Copy, &Move};
     };
 
   public:
-    constexpr Any() noexcept : data_(nullptr) {}
+    constexpr Any() noexcept = default;
 
     template <typename T>
-    constexpr Any(const T &value) : data_(Derive<T>::MakeData(value)) {}
+      requires (!SameAs<std::decay_t<T>, Any>)
+    Any(T &&value) {
+      Handler<std::decay_t<T>>::MakeData(*this, tystl::Forward<T>(value));
+    }
 
-    constexpr Any(const Any &other) {
-      if (other.data_ != nullptr) {
-        data_ = other.data_->Clone();
-      } else {
-        data_ = nullptr;
+    Any(const Any &other) {
+      if (other.operations_ != nullptr) {
+        other.operations_->copy(other, *this);
       }
     }
 
-    constexpr Any(Any &&other) noexcept : data_(std::exchange(other.data_, nullptr)) {}
+    Any(Any &&other) noexcept {
+      MoveFrom(other);
+    }
 
-    constexpr Any& operator=(const Any &other) {
-      Any tmp = other;
-      tmp.Swap(*this);
+    Any& operator=(const Any &other) {
+      if (this != &other) {
+        Any tmp = other;
+        Reset();
+        MoveFrom(tmp);
+      }
       return *this;
     }
 
-    constexpr Any& operator=(Any &&other) noexcept {
-      data_ = std::exchange(other.data_, nullptr);
+    Any& operator=(Any &&other) noexcept {
+      if (this != &other) {
+        Reset();
+        MoveFrom(other);
+      }
       return *this;
     }
 
+    ~Any() {
+      Reset();
+    }
+
     void Swap(Any &other) noexcept {
-      tystl::Swap(data_, other.data_);
+      Any tmp = tystl::Move(other);
+      other = tystl::Move(*this);
+      *this = tystl::Move(tmp);
     }
 
     constexpr bool HasValue() const noexcept {
-      return data_ != nullptr;
+      return operations_ != nullptr;
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    constexpr bool Holds() const noexcept {
+      return operations_ == &Handler<T>::kOperations;
     }
 
     template <typename T, typename ...Args>
       requires requires (Args ...args) { T(args...); }
-    constexpr void Emplace(Args &&...args) {
-      data_ = Derive<T>::MakeData(std::forward<Args>(args)...);
+    void Emplace(Args &&...args) {
+      Reset();
+      Handler<T>::MakeData(*this, std::forward<Args>(args)...);
     }
 
-    constexpr void Reset() {
-      data_ = nullptr;
+    void Reset() noexcept {
+      if (operations_ != nullptr) {
+        operations_->destroy(*this);
+        operations_ = nullptr;
+      }
     }
 
     template <typename T>
     [[nodiscard]]
-    T* Cast() const {
-      if (auto ptr = dynamic_cast<Derive<T>*>(data_.get())) {
-        return std::addressof(ptr->elem_);
+    T* Cast() const noexcept {
+      if (Holds<T>()) {
+        return Handler<T>::Get(*this);
       }
       return nullptr;
-    } 
+    }
+
+    // Like 'Cast', for callers that already know the Any holds a 'T'.
+    template <typename T>
+    [[nodiscard]]
+    T* UnsafeCast() const noexcept {
+      return Handler<T>::Get(*this);
+    }
 
   private:
-    std::unique_ptr<Base> data_;
+    // Takes the value of 'other', which is left empty.
+    void MoveFrom(Any &other) noexcept {
+      if (other.operations_ != nullptr) {
+        other.operations_->move(other, *this);
+        other.operations_ = nullptr;
+      }
+    }
+
+  private:
+    union Storage {
+      void *heap;
+      alignas(kInlineAlign) unsigned char buffer[kInlineSize];
+    };
+
+    const Operations* operations_ = nullptr;
+    Storage storage_;
   };
 
+  static_assert(sizeof(Any) == sizeof(void*) + Any::kInlineSize);
+
   template <typename T, typename ...Args>
     requires requires (Args ...args) { T(args...); }
   [[nodiscard]]
-  constexpr Any MakeAny(Args &&...args) {
-    return Any(T(std::forward<Args>(args)...));
+  Any MakeAny(Args &&...args) {
+    Any result;
+    result.Emplace<T>(std::forward<Args>(args)...);
+    return result;
   }
 }
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Utility.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace tystl {
+
+// A monotonic allocator: memory is handed out by bumping a pointer through
+// large blocks and is only given back all at once, by 'Reset' or when the
+// Arena is destroyed. Individual deallocations do nothing.
+//
+// Objects made with 'Create' whose destructor is not trivial are destroyed,
+// newest first, by 'Reset'; memory taken with 'Allocate' is simply dropped.
+// 'Reset' keeps the blocks, so an Arena reused per request stops allocating
+// once it has grown to the largest request. Not thread safe.
+class Arena {
+public:
+  static constexpr std::size_t kDefaultBlockSize = 64 * 1024;
+
+public:
+  explicit Arena(std::size_t block_size = kDefaultBlockSize) noexcept : block_size_(block_size) {}
+
+  Arena(const Arena &) = delete;
+
+  Arena& operator=(const Arena &) = delete;
+
+  ~Arena() {
+    this->Reset();
+    while (head_ != nullptr) {
+      auto *next = head_->next;
+      ::operator delete(head_, head_->size, std::align_val_t{alignof(Block)});
+      head_ = next;
+    }
+  }
+
+public:
+  [[nodiscard]]
+  void* Allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+    if (current_ != nullptr) {
+      if (auto *ptr = TryBump(*current_, bytes, align)) {
+        return ptr;
+      }
+    }
+    return this->AllocateSlow(bytes, align);
+  }
+
+  // Memory goes back with the next 'Reset'.
+  void Deallocate(void *, std::size_t, std::size_t = alignof(std::max_align_t)) noexcept {}
+
+  // Allocates and constructs a 'T' that lives until the next 'Reset'.
+  template <typename T, typename ...Args>
+    requires std::is_constructible_v<T, Args...>
+  [[nodiscard]]
+  T* Create(Args &&...args) {
+    if constexpr (std::is_trivially_destructible_v<T>) {
+      return ::new (this->Allocate(sizeof(T), alignof(T))) T(tystl::Forward<Args>(args)...);
+    } else {
+      // The cleanup record is reserved first so that registering it cannot
+      // fail once the object exists.
+      auto *cleanup = static_cast<Cleanup*>(this->Allocate(sizeof(Cleanup), alignof(Cleanup)));
+      auto *object = ::new (this->Allocate(sizeof(T), alignof(T))) T(tystl::Forward<Args>(args)...);
+      cleanups_ = ::new (cleanup) Cleanup{[](void *ptr) noexcept { static_cast<T*>(ptr)->~T(); }, object, cleanups_};
+      return object;
+    }
+  }
+
+  // Destroys the objects made with 'Create' and makes all memory available
+  // again, keeping the blocks for reuse.
+  void Reset() noexcept {
+    for (; cleanups_ != nullptr; cleanups_ = cleanups_->next) {
+      cleanups_->destroy(cleanups_->object);
+    }
+    for (auto *block = head_; block != nullptr; block = block->next) {
+      block->used = sizeof(Block);
+    }
+    current_ = head_;
+  }
+
+  // Bytes reserved from the system, including block headers.
+  [[nodiscard]]
+  std::size_t Capacity() const noexcept {
+    std::size_t total = 0;
+    for (auto *block = head_; block != nullptr; block = block->next) {
+      total += block->size;
+    }
+    return total;
+  }
+
+private:
+  struct alignas(std::max_align_t) Block {
+    Block *next;
+    std::size_t size;
+    std::size_t used;
+  };
+
+  struct Cleanup {
+    void (*destroy)(void *object) noexcept;
+    void *object;
+    Cleanup *next;
+  };
+
+  static void* TryBump(Block &block, std::size_t bytes, std::size_t align) noexcept {
+    auto base = reinterpret_cast<std::uintptr_t>(&block);
+    auto start = (base + block.used + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+    if (start + bytes > base + block.size) {
+      return nullptr;
+    }
+    block.used = start + bytes - base;
+    return reinterpret_cast<void*>(start);
+  }
+
+  // Moves on to the next kept block that fits, or adds a new one after the
+  // current block.
+  void* AllocateSlow(std::size_t bytes, std::size_t align) {
+    if (current_ != nullptr) {
+      for (auto *block = current_->next; block != nullptr; block = block->next) {
+        if (auto *ptr = TryBump(*block, bytes, align)) {
+          current_ = block;
+          return ptr;
+        }
+      }
+    }
+    auto size = std::max(block_size_, sizeof(Block) + bytes + align);
+    auto *block = ::new (::operator new(size, std::align_val_t{alignof(Block)})) Block{nullptr, size, sizeof(Block)};
+    if (current_ == nullptr) {
+      block->next = head_;
+      head_ = block;
+    } else {
+      block->next = current_->next;
+      current_->next = block;
+    }
+    current_ = block;
+    return TryBump(*block, bytes, align);
+  }
+
+private:
+  std::size_t block_size_;
+  Block *head_ = nullptr;
+  Block *current_ = nullptr;
+  Cleanup *cleanups_ = nullptr;
+};
+
+// A standard allocator that takes its memory from an Arena, for containers
+// whose elements should all go away with the next 'Reset'. Two of them are
+// equal when they share the Arena.
+template <typename T>
+class ArenaAllocator {
+public:
+  using value_type = T;
+
+public:
+  ArenaAllocator(Arena &arena) noexcept : arena_(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.GetArena()) {}
+
+  [[nodiscard]]
+  T* allocate(std::size_t count) {
+    if (count > std::size_t(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(arena_->Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *, std::size_t) noexcept {}
+
+  [[nodiscard]]
+  Arena* GetArena() const noexcept {
+    return arena_;
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &other) const noexcept {
+    return arena_ == other.GetArena();
+  }
+
+private:
+  Arena *arena_;
+};
+
+}
@@ -1,10 +1,18 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <compare>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
 #include <type_traits>
 
+#include "Hash.hpp"
 #include "Utility.hpp"
 
 namespace tystl {
@@ -12,6 +20,16 @@ namespace tystl {
 template <typename T>
 concept ArrayType = std::is_move_constructible_v<T> && std::is_move_assignable_v<T>; 
 
+// Integers whose value is exactly their bytes, so equality and hashing can
+// work on the raw memory of a whole array.
+template <typename T>
+inline constexpr bool IsBytewiseComparable = std::is_integral_v<T> && std::has_unique_object_representations_v<T>;
+
+// Bytewise comparable types whose order is also the order of their bytes
+// as compared by memcmp.
+template <typename T>
+inline constexpr bool IsBytewiseOrdered = IsBytewiseComparable<T> && sizeof(T) == 1 && std::is_unsigned_v<T>;
+
 template <ArrayType T, std::size_t N>
 struct Array {
 public:
@@ -22,9 +40,25 @@ public:
   using const_pointer   = const T*;
   using reference       = T&;
   using const_reference = const T&;
+  // Plain pointers, so the standard and parallel algorithms see contiguous
+  // memory and can vectorize over it.
+  using iterator               = T*;
+  using const_iterator         = const T*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
   
 public:
   constexpr void Fill(const T &value) {
+    if !consteval {
+      if constexpr (IsBytewiseComparable<T>) {
+        // Values such as 0 or -1 repeat one byte, which memset fills at full width.
+        auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(value);
+        if (std::all_of(bytes.begin(), bytes.end(), [&](unsigned char byte) { return byte == bytes[0]; })) {
+          std::memset(elems_, bytes[0], sizeof(elems_));
+          return;
+        }
+      }
+    }
     std::fill_n(elems_, N, value);
   }
 
@@ -32,13 +66,58 @@ public:
     tystl::Swap(elems_, other.elems_);
   }
 
-  // constexpr auto begin();
+  constexpr iterator begin() noexcept {
+    return elems_;
+  }
+
+  constexpr const_iterator begin() const noexcept {
+    return elems_;
+  }
+
+  constexpr iterator end() noexcept {
+    return elems_ + N;
+  }
+
+  constexpr const_iterator end() const noexcept {
+    return elems_ + N;
+  }
 
-  // constexpr auto end();
+  constexpr const_iterator cbegin() const noexcept {
+    return begin();
+  }
 
-  // constexpr auto cbegin();
+  constexpr const_iterator cend() const noexcept {
+    return end();
+  }
 
-  // constexpr auto cend();
+  constexpr reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  constexpr const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  constexpr reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  constexpr const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  constexpr const_reverse_iterator crbegin() const noexcept {
+    return rbegin();
+  }
+
+  constexpr const_reverse_iterator crend() const noexcept {
+    return rend();
+  }
+
+  // Lower case so std::ranges::size and friends find it.
+  constexpr size_type size() const noexcept {
+    return N;
+  }
 
   constexpr size_type Size() const noexcept {
     return N;
@@ -55,7 +134,7 @@ public:
   [[nodiscard]]
   constexpr reference At(size_type pos) {
     if (N <= pos) {
-
+      throw std::out_of_range("Array::At");
     }
     return elems_[pos];
   }
@@ -63,7 +142,7 @@ public:
   [[nodiscard]]
   constexpr const_reference At(size_type pos) const {
     if (N <= pos) {
-
+      throw std::out_of_range("Array::At");
     }
     return elems_[pos];
   }
@@ -108,15 +187,88 @@ public:
     return elems_;
   }
 
+  [[nodiscard]]
+  constexpr bool operator==(const Array &right) const {
+    if !consteval {
+      if constexpr (IsBytewiseComparable<T>) {
+        return std::memcmp(elems_, right.elems_, sizeof(elems_)) == 0;
+      }
+    }
+    return std::equal(elems_, elems_ + N, right.elems_);
+  }
+
+  [[nodiscard]]
   constexpr auto operator<=>(const Array &right) const {
-    for (size_type i = 0; i < N; i ++) {
-      if (auto result = elems_[i] <=> right[i]; result == 0) {
-        continue;
-      } else {
-        return result;
+    if !consteval {
+      if constexpr (IsBytewiseOrdered<T>) {
+        return std::memcmp(elems_, right.elems_, sizeof(elems_)) <=> 0;
+      } else if constexpr (IsBytewiseComparable<T>) {
+        // memcmp skips the equal prefix a block at a time, the first
+        // differing element inside the block is located a word at a time.
+        constexpr size_type kBlock = 256 / sizeof(T) > 0 ? 256 / sizeof(T) : 1;
+        for (size_type first = 0; first < N; first += kBlock) {
+          auto count = std::min(kBlock, N - first);
+          if (std::memcmp(elems_ + first, right.elems_ + first, count * sizeof(T)) != 0) {
+            auto pos = first + FirstDifference(elems_ + first, right.elems_ + first, count);
+            return std::compare_three_way_result_t<T>(elems_[pos] <=> right.elems_[pos]);
+          }
+        }
+        return std::compare_three_way_result_t<T>(std::strong_ordering::equal);
       }
     }
-    return std::strong_ordering::equal;
+    return CompareRange(right, 0, N);
+  }
+
+  // Hash of the elements. Bytewise comparable elements are hashed as one
+  // block of memory, others element by element through std::hash.
+  [[nodiscard]]
+  std::size_t Hash() const noexcept
+    requires IsBytewiseComparable<T> || requires (const T &value) { std::hash<T>{}(value); } {
+    if constexpr (IsBytewiseComparable<T>) {
+      return static_cast<std::size_t>(HashBytes(elems_, sizeof(elems_)));
+    } else {
+      std::uint64_t seed = N;
+      for (const auto &elem : elems_) {
+        seed = HashCombine(seed, std::hash<T>{}(elem));
+      }
+      return static_cast<std::size_t>(seed);
+    }
+  }
+
+private:
+  // Index of the first element that differs between two ranges known to differ.
+  static size_type FirstDifference(const T *left, const T *right, size_type count) noexcept {
+    if constexpr (std::endian::native == std::endian::little) {
+      const auto *lhs = reinterpret_cast<const unsigned char*>(left);
+      const auto *rhs = reinterpret_cast<const unsigned char*>(right);
+      size_type byte = 0;
+      for (; byte + sizeof(std::uint64_t) <= count * sizeof(T); byte += sizeof(std::uint64_t)) {
+        std::uint64_t lword, rword;
+        std::memcpy(&lword, lhs + byte, sizeof(lword));
+        std::memcpy(&rword, rhs + byte, sizeof(rword));
+        if (auto diff = lword ^ rword; diff != 0) {
+          return (byte + static_cast<size_type>(std::countr_zero(diff)) / 8) / sizeof(T);
+        }
+      }
+      for (auto i = byte / sizeof(T); i < count; i ++) {
+        if (left[i] != right[i]) {
+          return i;
+        }
+      }
+      return count;
+    } else {
+      return static_cast<size_type>(std::mismatch(left, left + count, right).first - left);
+    }
+  }
+
+  constexpr auto CompareRange(const Array &right, size_type first, size_type last) const {
+    using Result = std::compare_three_way_result_t<T>;
+    for (size_type i = first; i < last; i ++) {
+      if (auto result = elems_[i] <=> right.elems_[i]; result != 0) {
+        return Result(result);
+      }
+    }
+    return Result(std::strong_ordering::equal);
   }
 
 public:
@@ -133,10 +285,29 @@ public:
   using const_pointer   = const T*;
   using reference       = T&;
   using const_reference = const T&;
+  using iterator               = T*;
+  using const_iterator         = const T*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 public:
   constexpr void Fill(const T&) {}
 
+  [[nodiscard]]
+  constexpr bool operator==(const Array &) const noexcept {
+    return true;
+  }
+
+  [[nodiscard]]
+  constexpr std::strong_ordering operator<=>(const Array &) const noexcept {
+    return std::strong_ordering::equal;
+  }
+
+  [[nodiscard]]
+  std::size_t Hash() const noexcept {
+    return static_cast<std::size_t>(HashBytes(nullptr, 0));
+  }
+
   constexpr void Swap(Array&) noexcept {}
 
   constexpr size_type Size() const noexcept {
@@ -151,11 +322,68 @@ public:
     return true;
   }
 
+  constexpr iterator begin() noexcept {
+    return nullptr;
+  }
+
+  constexpr const_iterator begin() const noexcept {
+    return nullptr;
+  }
+
+  constexpr iterator end() noexcept {
+    return nullptr;
+  }
+
+  constexpr const_iterator end() const noexcept {
+    return nullptr;
+  }
+
+  constexpr const_iterator cbegin() const noexcept {
+    return nullptr;
+  }
+
+  constexpr const_iterator cend() const noexcept {
+    return nullptr;
+  }
+
+  constexpr reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  constexpr const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  constexpr reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  constexpr const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  constexpr const_reverse_iterator crbegin() const noexcept {
+    return rbegin();
+  }
+
+  constexpr const_reverse_iterator crend() const noexcept {
+    return rend();
+  }
+
+  constexpr size_type size() const noexcept {
+    return 0;
+  }
+
+  // Every position is out of range.
   [[noreturn]]
-  reference At(size_type) {}
+  reference At(size_type) {
+    throw std::out_of_range("Array::At");
+  }
 
   [[noreturn]]
-  const_reference At() const {}
+  const_reference At(size_type) const {
+    throw std::out_of_range("Array::At");
+  }
 
   constexpr reference operator[](size_type) noexcept {
     return *Data();
@@ -193,4 +421,7 @@ public:
 template <typename T, typename ...Ts>
 Array(T, Ts...) -> Array<T, 1 + sizeof...(Ts)>;
 
+static_assert(std::contiguous_iterator<Array<int, 4>::iterator>);
+static_assert(std::contiguous_iterator<Array<int, 4>::const_iterator>);
+
 } // namespace tystl
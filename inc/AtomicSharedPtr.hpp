@@ -0,0 +1,195 @@
+#pragma once
+
+#include "SharedPtr.hpp"
+#include "Utility.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+namespace tystl {
+
+// A SharedPtr slot that can be loaded and replaced from many threads.
+//
+// The slot is one word: the control block pointer in the low 48 bits and a
+// local reference count in the high 16 bits (split reference counting).
+// 'Load' bumps the local count to pin the block, takes a real strong
+// reference, then gives the local one back. Whoever swaps a block out of the
+// slot converts the local count still pending into strong references, so
+// readers that lost the race release theirs on the block instead. No
+// operation takes a lock; at most 32767 loads may be in flight at once.
+template <typename T, typename Policy>
+class AtomicSharedPtr {
+  static_assert(IsSameValue<Policy, AtomicRefPolicy>,
+                "AtomicSharedPtr requires thread safe reference counting");
+  static_assert(sizeof(void *) == sizeof(std::uint64_t),
+                "AtomicSharedPtr packs a 48 bit pointer into a 64 bit word");
+
+  using Block = RefCountBase<Policy>;
+  using Word = std::uint64_t;
+
+public:
+  using ValueType = SharedPtr<T, Policy>;
+
+  static constexpr bool IsAlwaysLockFree = std::atomic<Word>::is_always_lock_free;
+
+public:
+  constexpr AtomicSharedPtr() noexcept = default;
+
+  constexpr AtomicSharedPtr(std::nullptr_t) noexcept {}
+
+  AtomicSharedPtr(ValueType desired) noexcept : word_(Pack(Release(desired))) {}
+
+  AtomicSharedPtr(const AtomicSharedPtr &) = delete;
+
+  AtomicSharedPtr& operator=(const AtomicSharedPtr &) = delete;
+
+  ~AtomicSharedPtr() {
+    Drop(word_.load(std::memory_order_acquire));
+  }
+
+  AtomicSharedPtr& operator=(ValueType desired) noexcept {
+    Store(tystl::Move(desired));
+    return *this;
+  }
+
+  operator ValueType() const noexcept {
+    return Load();
+  }
+
+  [[nodiscard]]
+  bool IsLockFree() const noexcept {
+    return word_.is_lock_free();
+  }
+
+  [[nodiscard]]
+  ValueType Load() const noexcept {
+    if (UnpackBlock(word_.load(std::memory_order_relaxed)) == nullptr) {
+      return ValueType();
+    }
+
+    auto word = word_.fetch_add(kCountOne, std::memory_order_acquire);
+    auto *block = UnpackBlock(word);
+    if (block == nullptr) {
+      // A null slot never hands its local count over, so it can stay behind.
+      return ValueType();
+    }
+
+    block->AddRef();
+    auto current = word + kCountOne;
+    while (true) {
+      if (UnpackBlock(current) != block) {
+        // The block was swapped out and our local reference became a strong one.
+        block->SubRef();
+        break;
+      }
+      if (word_.compare_exchange_weak(current, current - kCountOne,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    return Adopt(block);
+  }
+
+  void Store(ValueType desired) noexcept {
+    Drop(word_.exchange(Pack(Release(desired)), std::memory_order_acq_rel));
+  }
+
+  [[nodiscard]]
+  ValueType Exchange(ValueType desired) noexcept {
+    auto word = word_.exchange(Pack(Release(desired)), std::memory_order_acq_rel);
+    auto *block = UnpackBlock(word);
+    if (block != nullptr) {
+      HandOverLocalCount(block, word);
+    }
+    return Adopt(block);
+  }
+
+  // Replaces the stored pointer with 'desired' if it owns the same object as
+  // 'expected', otherwise loads the stored pointer into 'expected'.
+  bool CompareExchange(ValueType &expected, ValueType desired) noexcept {
+    auto *expected_block = expected.ref_counter_;
+    auto word = word_.load(std::memory_order_relaxed);
+    while (true) {
+      if (UnpackBlock(word) != expected_block) {
+        auto current = Load();
+        if (current.ref_counter_ == expected_block) {
+          word = word_.load(std::memory_order_relaxed);
+          continue;
+        }
+        expected = tystl::Move(current);
+        return false;
+      }
+
+      if (word_.compare_exchange_weak(word, Pack(desired.ref_counter_),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+        Release(desired);
+        Drop(word);
+        return true;
+      }
+    }
+  }
+
+private:
+  static constexpr int kCountShift = 48;
+  static constexpr Word kCountOne = Word{1} << kCountShift;
+  static constexpr Word kPointerMask = kCountOne - 1;
+
+  // The top bits of the word hold the local count, so a block above 2^48
+  // would corrupt it. Every block enters the slot through here, and such a
+  // block is refused in every build mode rather than stored.
+  static Word Pack(Block *block) noexcept {
+    auto address = static_cast<Word>(reinterpret_cast<std::uintptr_t>(block));
+    if ((address & ~kPointerMask) != 0) [[unlikely]] {
+      std::abort();
+    }
+    return address;
+  }
+
+  static Block* UnpackBlock(Word word) noexcept {
+    return reinterpret_cast<Block *>(static_cast<std::uintptr_t>(word & kPointerMask));
+  }
+
+  // The count may have wrapped below zero when a reader hands its reference
+  // back to a later occupancy of the same block, so it is read as signed.
+  static std::int16_t UnpackCount(Word word) noexcept {
+    return static_cast<std::int16_t>(static_cast<std::uint16_t>(word >> kCountShift));
+  }
+
+  // Takes over the reference held by 'ptr' without touching the counters.
+  static Block* Release(ValueType &ptr) noexcept {
+    ptr.ptr_ = nullptr;
+    return std::exchange(ptr.ref_counter_, nullptr);
+  }
+
+  // Wraps a block whose strong reference the caller already owns.
+  static ValueType Adopt(Block *block) noexcept {
+    ValueType result;
+    if (block != nullptr) {
+      result.Init(static_cast<T *>(block->GetResource()), block);
+    }
+    return result;
+  }
+
+  static void HandOverLocalCount(Block *block, Word word) noexcept {
+    if (auto count = UnpackCount(word); count != 0) {
+      block->AddRefs(static_cast<std::size_t>(static_cast<std::ptrdiff_t>(count)));
+    }
+  }
+
+  // Releases the reference the slot held through 'word'.
+  static void Drop(Word word) noexcept {
+    if (auto *block = UnpackBlock(word)) {
+      HandOverLocalCount(block, word);
+      block->SubRef();
+    }
+  }
+
+private:
+  mutable std::atomic<Word> word_{0};
+};
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tystl {
+
+// Tells the CPU the thread is spinning, which on x86 frees resources for the
+// sibling hyperthread and avoids a memory order mis-speculation on exit.
+inline void CpuRelax() noexcept {
+#if defined(__SSE2__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Exponential backoff for spin loops: each 'Pause' spins twice as long as
+// the previous one, up to a limit past which it yields the thread instead.
+class Backoff {
+public:
+  void Pause() noexcept {
+    if (step_ < kSpinSteps) {
+      for (std::uint32_t i = 0; i < (1u << step_); i ++) {
+        CpuRelax();
+      }
+      step_ ++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  void Reset() noexcept {
+    step_ = 0;
+  }
+
+private:
+  static constexpr std::uint32_t kSpinSteps = 7;
+
+  std::uint32_t step_ = 0;
+};
+
+}
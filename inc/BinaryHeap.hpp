@@ -1,10 +1,22 @@
+#pragma once
+
+#include "Instrument.hpp"
 #include "Utility.hpp"
-#include <vector>
+#include "Vector.hpp"
+#include <bit>
+#include <cstddef>
+#include <ranges>
+#include <type_traits>
 
 namespace tystl {
 
-template <typename Ty, typename Compare, typename Container = std::vector<Ty>>
-  requires requires(Compare comp, Ty a, Ty b) {
+// A d-ary heap, the element 'comp' orders first is on top. Every node has
+// 'Arity' children stored next to each other, so a wider heap is shallower
+// and compares siblings within the same cache line. Sifting moves a hole
+// instead of swapping: every element on the path is moved once and the
+// displaced value is written only where it finally lands.
+template <typename Ty, typename Compare, typename Container = Vector<Ty>, std::size_t Arity = 2>
+  requires (Arity >= 2) && requires(Compare comp, Ty a, Ty b) {
     { comp(a, b) } -> std::same_as<bool>;
   } &&
            requires(Container cont, Ty value) {
@@ -26,8 +38,6 @@ class BinaryHeap {
 public:
   BinaryHeap() : cont_(), comp_() {}
  
-  explicit BinaryHeap(const Compare &comp) : cont_(), comp_(comp) {}
- 
   explicit BinaryHeap(Compare comp) : cont_(), comp_(tystl::Move(comp)) {}
  
   BinaryHeap(const BinaryHeap &other)
@@ -39,9 +49,7 @@ public:
   template <typename Comp, typename Cont>
   explicit BinaryHeap(Comp &&comp, Cont &&cont)
       : cont_(tystl::Forward<Cont>(cont)), comp_(tystl::Forward<Comp>(comp)) {
-    for (int i = static_cast<int>(this->cont_.size()) - 1; i >= 0; i--) {
-      this->Down(i);
-    }
+    this->MakeHeap();
   }
  
   auto operator=(BinaryHeap other) -> BinaryHeap & {
@@ -73,38 +81,132 @@ public:
     this->Up(this->Size() - 1);
   }
  
+  // Appends every element of 'range'. A batch that is large next to the heap
+  // is appended as is and the heap rebuilt in O(n), a small one is sifted
+  // in element by element.
+  template <std::ranges::input_range Range>
+    requires requires(std::ranges::range_reference_t<Range> value) { Ty(value); }
+  auto PushRange(Range &&range) -> void {
+    auto old_size = this->Size();
+    for (auto &&value : range) {
+      this->cont_.emplace_back(std::forward<decltype(value)>(value));
+    }
+    this->RestoreAppended(old_size);
+  }
+ 
+  // Moves every element of 'other' into this heap and leaves 'other' empty.
+  auto Merge(BinaryHeap &&other) -> void {
+    if (other.Size() > this->Size()) {
+      tystl::Swap(this->cont_, other.cont_);
+    }
+    auto old_size = this->Size();
+    for (std::size_t i = 0; i < other.Size(); i++) {
+      this->cont_.emplace_back(tystl::Move(other.cont_[i]));
+    }
+    other.cont_ = Container();
+    this->RestoreAppended(old_size);
+  }
+ 
   auto Top() const -> const Ty & { return this->cont_[0]; }
  
   auto Top() -> Ty & { return this->cont_[0]; }
  
   auto Pop() -> void {
-    tystl::Swap(this->cont_.front(), this->cont_.back());
+    Ty value = tystl::Move(this->cont_.back());
     this->cont_.pop_back();
-    this->Down(0);
+    if (!this->Empty()) {
+      this->SiftDown(0, tystl::Move(value));
+    }
   }
  
 private:
+  static constexpr auto Parent(std::size_t idx) noexcept -> std::size_t {
+    return (idx - 1) / Arity;
+  }
+
+  static constexpr auto FirstChild(std::size_t idx) noexcept -> std::size_t {
+    return idx * Arity + 1;
+  }
+
+  // Floyd's bottom-up construction.
+  auto MakeHeap() -> void {
+    if (this->Size() > 1) {
+      for (auto i = Parent(this->Size() - 1) + 1; i-- > 0;) {
+        this->Down(i);
+      }
+    }
+  }
+
+  // Restores the heap after elements were appended past 'old_size'. Sifting
+  // each one up costs about k * log(n), rebuilding costs about n.
+  auto RestoreAppended(std::size_t old_size) -> void {
+    auto size = this->Size();
+    auto appended = size - old_size;
+    if (appended * static_cast<std::size_t>(std::bit_width(size)) >= size) {
+      this->MakeHeap();
+      return;
+    }
+    for (auto i = old_size; i < size; i++) {
+      this->Up(i);
+    }
+  }
+
   auto Up(std::size_t idx) -> void {
-    while (idx > 0 &&
-           this->comp_(this->cont_[idx], this->cont_[(idx - 1) / 2])) {
-      tystl::Swap(this->cont_[(idx - 1) / 2], this->cont_[idx]);
-      idx = (idx - 1) / 2;
+    if (idx == 0) {
+      return;
     }
+    Ty value = tystl::Move(this->cont_[idx]);
+    this->SiftUp(idx, tystl::Move(value));
   }
  
   auto Down(std::size_t idx) -> void {
-    while (idx * 2 + 1 < this->Size()) {
-      auto t = idx * 2 + 1;
-      if (t + 1 < this->Size() &&
-          this->comp_(this->cont_[t + 1], this->cont_[t])) {
-        t += 1;
+    if (idx >= this->Size()) {
+      return;
+    }
+    Ty value = tystl::Move(this->cont_[idx]);
+    this->SiftDown(idx, tystl::Move(value));
+  }
+
+  // 'comp_', counted when instrumentation is on.
+  auto Before(const Ty &left, const Ty &right) -> bool {
+    instrument::Count(instrument::Counter::kHeapComparisons);
+    return this->comp_(left, right);
+  }
+
+  // Moves the hole at 'idx' towards the root until 'value' fits in it.
+  auto SiftUp(std::size_t idx, Ty value) -> void {
+    std::size_t levels = 0;
+    while (idx > 0 && this->Before(value, this->cont_[Parent(idx)])) {
+      this->cont_[idx] = tystl::Move(this->cont_[Parent(idx)]);
+      idx = Parent(idx);
+      levels++;
+    }
+    this->cont_[idx] = tystl::Move(value);
+    instrument::CountSift(levels);
+  }
+
+  // Moves the hole at 'idx' towards the leaves until 'value' fits in it.
+  auto SiftDown(std::size_t idx, Ty value) -> void {
+    const auto size = this->Size();
+    std::size_t levels = 0;
+    while (FirstChild(idx) < size) {
+      auto first = FirstChild(idx);
+      auto last = size - first < Arity ? size : first + Arity;
+      auto best = first;
+      for (auto child = first + 1; child < last; child++) {
+        if (this->Before(this->cont_[child], this->cont_[best])) {
+          best = child;
+        }
       }
-      if (this->comp_(this->cont_[idx], this->cont_[t])) {
+      if (!this->Before(this->cont_[best], value)) {
         break;
       }
-      tystl::Swap(this->cont_[idx], this->cont_[t]);
-      idx = t;
+      this->cont_[idx] = tystl::Move(this->cont_[best]);
+      idx = best;
+      levels++;
     }
+    this->cont_[idx] = tystl::Move(value);
+    instrument::CountSift(levels);
   }
  
 private:
@@ -114,7 +216,206 @@ private:
  
 template <typename Comp, typename Cont>
 BinaryHeap(Comp &&, Cont &&)
-    -> BinaryHeap<typename Cont::value_type, Comp, Cont>;
-    
-}
+    -> BinaryHeap<typename std::remove_cvref_t<Cont>::value_type,
+                  std::remove_cvref_t<Comp>, std::remove_cvref_t<Cont>>;
 
+// A d-ary heap whose elements stay reachable after insertion. 'Push' returns
+// a handle that is valid until its element is popped or erased, after which
+// the handle may be reused by a later push. A handle -> position index is
+// kept next to the elements and updated on every move, so 'Update',
+// 'DecreaseKey' and 'Erase' run in O(log n).
+template <typename Ty, typename Compare, std::size_t Arity = 2>
+  requires (Arity >= 2) && requires(Compare comp, Ty a, Ty b) {
+    { comp(a, b) } -> std::same_as<bool>;
+  }
+class IndexedBinaryHeap {
+public:
+  class Handle {
+  public:
+    constexpr Handle() noexcept = default;
+ 
+    constexpr auto operator<=>(const Handle &) const noexcept = default;
+ 
+  private:
+    friend class IndexedBinaryHeap;
+ 
+    constexpr explicit Handle(std::size_t id) noexcept : id_(id) {}
+ 
+    std::size_t id_ = kNoPosition;
+  };
+ 
+public:
+  IndexedBinaryHeap() : comp_() {}
+ 
+  explicit IndexedBinaryHeap(Compare comp) : comp_(tystl::Move(comp)) {}
+ 
+  auto Swap(IndexedBinaryHeap &other) noexcept -> void {
+    tystl::Swap(this->entries_, other.entries_);
+    tystl::Swap(this->positions_, other.positions_);
+    tystl::Swap(this->free_ids_, other.free_ids_);
+    tystl::Swap(this->comp_, other.comp_);
+  }
+ 
+public:
+  auto Size() const noexcept -> std::size_t { return this->entries_.size(); }
+ 
+  auto Empty() const noexcept -> bool { return this->entries_.empty(); }
+ 
+  auto Push(Ty value) -> Handle {
+    return this->Emplace(tystl::Move(value));
+  }
+ 
+  template <typename... Ts>
+    requires requires(Ts &&...args) { Ty(std::forward<Ts>(args)...); }
+  auto Emplace(Ts &&...args) -> Handle {
+    Ty value(std::forward<Ts>(args)...);
+    auto id = this->AcquireId();
+    auto idx = this->Size();
+    try {
+      this->entries_.push_back(Entry{tystl::Move(value), id});
+    } catch (...) {
+      this->ReleaseId(id);
+      throw;
+    }
+    this->positions_[id] = idx;
+    this->Restore(idx);
+    return Handle(id);
+  }
+ 
+  auto Top() const -> const Ty & { return this->entries_[0].value; }
+ 
+  auto TopHandle() const -> Handle { return Handle(this->entries_[0].id); }
+ 
+  auto Pop() -> void {
+    this->Erase(this->TopHandle());
+  }
+ 
+  auto Contains(Handle handle) const noexcept -> bool {
+    return handle.id_ < this->positions_.size() &&
+           this->positions_[handle.id_] != kNoPosition;
+  }
+ 
+  auto Get(Handle handle) const -> const Ty & {
+    return this->entries_[this->positions_[handle.id_]].value;
+  }
+ 
+  // Replaces the element behind 'handle' and moves it to its new place.
+  auto Update(Handle handle, Ty value) -> void {
+    auto idx = this->positions_[handle.id_];
+    this->entries_[idx].value = tystl::Move(value);
+    this->Restore(idx);
+  }
+ 
+  // Like 'Update' for a value that does not order after the current one,
+  // so the element can only move towards the top.
+  auto DecreaseKey(Handle handle, Ty value) -> void {
+    auto idx = this->positions_[handle.id_];
+    this->SiftUp(idx, Entry{tystl::Move(value), handle.id_});
+  }
+ 
+  auto Erase(Handle handle) -> void {
+    auto idx = this->positions_[handle.id_];
+    this->ReleaseId(handle.id_);
+    Entry last = tystl::Move(this->entries_.back());
+    this->entries_.pop_back();
+    if (idx < this->Size()) {
+      this->entries_[idx] = tystl::Move(last);
+      this->positions_[this->entries_[idx].id] = idx;
+      this->Restore(idx);
+    }
+  }
+ 
+private:
+  static constexpr std::size_t kNoPosition = static_cast<std::size_t>(-1);
+ 
+  struct Entry {
+    Ty value;
+    std::size_t id;
+  };
+ 
+  static constexpr auto Parent(std::size_t idx) noexcept -> std::size_t {
+    return (idx - 1) / Arity;
+  }
+ 
+  static constexpr auto FirstChild(std::size_t idx) noexcept -> std::size_t {
+    return idx * Arity + 1;
+  }
+ 
+  auto AcquireId() -> std::size_t {
+    if (!this->free_ids_.empty()) {
+      auto id = this->free_ids_.back();
+      this->free_ids_.pop_back();
+      return id;
+    }
+    this->positions_.push_back(kNoPosition);
+    return this->positions_.size() - 1;
+  }
+ 
+  auto ReleaseId(std::size_t id) -> void {
+    this->positions_[id] = kNoPosition;
+    this->free_ids_.push_back(id);
+  }
+ 
+  auto Place(std::size_t idx, Entry &&entry) -> void {
+    this->positions_[entry.id] = idx;
+    this->entries_[idx] = tystl::Move(entry);
+  }
+ 
+  // 'comp_', counted when instrumentation is on.
+  auto Before(const Ty &left, const Ty &right) -> bool {
+    instrument::Count(instrument::Counter::kHeapComparisons);
+    return this->comp_(left, right);
+  }
+
+  // Sifts the element at 'idx' in whichever direction it has to go.
+  auto Restore(std::size_t idx) -> void {
+    Entry entry = tystl::Move(this->entries_[idx]);
+    if (idx > 0 && this->Before(entry.value, this->entries_[Parent(idx)].value)) {
+      this->SiftUp(idx, tystl::Move(entry));
+    } else {
+      this->SiftDown(idx, tystl::Move(entry));
+    }
+  }
+ 
+  auto SiftUp(std::size_t idx, Entry entry) -> void {
+    std::size_t levels = 0;
+    while (idx > 0 && this->Before(entry.value, this->entries_[Parent(idx)].value)) {
+      this->Place(idx, tystl::Move(this->entries_[Parent(idx)]));
+      idx = Parent(idx);
+      levels++;
+    }
+    this->Place(idx, tystl::Move(entry));
+    instrument::CountSift(levels);
+  }
+ 
+  auto SiftDown(std::size_t idx, Entry entry) -> void {
+    const auto size = this->Size();
+    std::size_t levels = 0;
+    while (FirstChild(idx) < size) {
+      auto first = FirstChild(idx);
+      auto last = size - first < Arity ? size : first + Arity;
+      auto best = first;
+      for (auto child = first + 1; child < last; child++) {
+        if (this->Before(this->entries_[child].value, this->entries_[best].value)) {
+          best = child;
+        }
+      }
+      if (!this->Before(this->entries_[best].value, entry.value)) {
+        break;
+      }
+      this->Place(idx, tystl::Move(this->entries_[best]));
+      idx = best;
+      levels++;
+    }
+    this->Place(idx, tystl::Move(entry));
+    instrument::CountSift(levels);
+  }
+ 
+private:
+  Vector<Entry> entries_;
+  Vector<std::size_t> positions_;
+  Vector<std::size_t> free_ids_;
+  Compare comp_;
+};
+ 
+}
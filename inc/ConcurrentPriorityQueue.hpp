@@ -0,0 +1,211 @@
+#pragma once
+
+#include "BinaryHeap.hpp"
+#include "Utility.hpp"
+#include "Vector.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tystl {
+
+// A priority queue for many producers and consumers, built as a MultiQueue:
+// several BinaryHeap shards, each behind its own lock. 'Push' goes to a
+// random shard. 'TryPop' picks two random shards and pops from the one whose
+// top 'comp' orders first, so an element near the top comes out soon but
+// not necessarily before all others. More shards scale further and order
+// more loosely.
+//
+// In strict mode 'TryPop' locks every shard and takes the global top, which
+// is linearizable but serializes the consumers.
+template <typename Ty, typename Compare, std::size_t Arity = 4>
+class ConcurrentPriorityQueue {
+  using Heap = BinaryHeap<Ty, Compare, Vector<Ty>, Arity>;
+
+public:
+  struct Options {
+    // Number of heaps, 0 means four per hardware thread.
+    std::size_t shards = 0;
+
+    bool strict = false;
+  };
+
+public:
+  ConcurrentPriorityQueue() : ConcurrentPriorityQueue(Options()) {}
+
+  explicit ConcurrentPriorityQueue(Options options, Compare comp = Compare())
+      : shard_count_(ShardCountFor(options)),
+        strict_(options.strict),
+        shards_(std::make_unique<Shard[]>(shard_count_)),
+        comp_(tystl::Move(comp)) {
+    for (std::size_t i = 0; i < shard_count_; i++) {
+      shards_[i].heap = Heap(comp_);
+    }
+  }
+
+  ConcurrentPriorityQueue(const ConcurrentPriorityQueue &) = delete;
+
+  ConcurrentPriorityQueue& operator=(const ConcurrentPriorityQueue &) = delete;
+
+  ~ConcurrentPriorityQueue() = default;
+
+public:
+  // Approximate while other threads push or pop.
+  auto Size() const noexcept -> std::size_t {
+    auto size = size_.load(std::memory_order_relaxed);
+    return size > 0 ? static_cast<std::size_t>(size) : 0;
+  }
+
+  auto Empty() const noexcept -> bool { return this->Size() == 0; }
+
+  auto ShardCount() const noexcept -> std::size_t { return shard_count_; }
+
+  auto Push(Ty value) -> void {
+    this->Emplace(tystl::Move(value));
+  }
+
+  template <typename... Ts>
+    requires requires(Ts &&...args) { Ty(std::forward<Ts>(args)...); }
+  auto Emplace(Ts &&...args) -> void {
+    auto &shard = this->LockAnyShard();
+    // Owns the lock from here, so a throwing constructor or a failed
+    // growth of the heap cannot leave the shard locked.
+    std::unique_lock<std::mutex> lock(shard.mutex, std::adopt_lock);
+    shard.heap.Emplace(std::forward<Ts>(args)...);
+    lock.unlock();
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Moves an element near the top into 'out'. Returns false if every shard
+  // was seen empty.
+  auto TryPop(Ty &out) -> bool {
+    if (strict_) {
+      return this->TryPopStrict(out);
+    }
+    if (shard_count_ > 1) {
+      for (std::size_t attempt = 0; attempt < shard_count_; attempt++) {
+        if (this->Empty()) {
+          break;
+        }
+        if (this->TryPopTwoChoice(out)) {
+          return true;
+        }
+      }
+    }
+    return this->TryPopAny(out);
+  }
+
+private:
+  struct alignas(kCacheLineSize) Shard {
+    std::mutex mutex;
+    Heap heap;
+  };
+
+  static constexpr std::size_t kPushAttempts = 4;
+
+  static auto ShardCountFor(const Options &options) -> std::size_t {
+    if (options.shards != 0) {
+      return options.shards;
+    }
+    auto threads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return 4 * (threads != 0 ? threads : 1);
+  }
+
+  static auto RandomBelow(std::size_t bound) noexcept -> std::size_t {
+    thread_local std::uint64_t state = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<std::uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<std::size_t>(state % bound);
+  }
+
+  // Returns a locked shard, preferring one no other thread holds.
+  auto LockAnyShard() -> Shard & {
+    for (std::size_t attempt = 0; attempt < kPushAttempts; attempt++) {
+      auto &shard = shards_[RandomBelow(shard_count_)];
+      if (shard.mutex.try_lock()) {
+        return shard;
+      }
+    }
+    auto &shard = shards_[RandomBelow(shard_count_)];
+    shard.mutex.lock();
+    return shard;
+  }
+
+  auto PopFrom(Shard &shard, Ty &out) -> void {
+    out = tystl::Move(shard.heap.Top());
+    shard.heap.Pop();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  auto TryPopTwoChoice(Ty &out) -> bool {
+    auto first = RandomBelow(shard_count_);
+    auto second = (first + 1 + RandomBelow(shard_count_ - 1)) % shard_count_;
+
+    std::unique_lock first_lock(shards_[first].mutex, std::try_to_lock);
+    if (!first_lock) {
+      return false;
+    }
+    std::unique_lock second_lock(shards_[second].mutex, std::try_to_lock);
+    if (!second_lock) {
+      return false;
+    }
+
+    auto &left = shards_[first].heap;
+    auto &right = shards_[second].heap;
+    if (left.Empty() && right.Empty()) {
+      return false;
+    }
+    if (right.Empty() || (!left.Empty() && !comp_(right.Top(), left.Top()))) {
+      this->PopFrom(shards_[first], out);
+    } else {
+      this->PopFrom(shards_[second], out);
+    }
+    return true;
+  }
+
+  // Walks every shard once, used when random picks keep missing.
+  auto TryPopAny(Ty &out) -> bool {
+    auto start = RandomBelow(shard_count_);
+    for (std::size_t i = 0; i < shard_count_; i++) {
+      auto &shard = shards_[(start + i) % shard_count_];
+      std::lock_guard lock(shard.mutex);
+      if (!shard.heap.Empty()) {
+        this->PopFrom(shard, out);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  auto TryPopStrict(Ty &out) -> bool {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shard_count_);
+    Shard *best = nullptr;
+    for (std::size_t i = 0; i < shard_count_; i++) {
+      locks.emplace_back(shards_[i].mutex);
+      auto &heap = shards_[i].heap;
+      if (!heap.Empty() && (best == nullptr || comp_(heap.Top(), best->heap.Top()))) {
+        best = &shards_[i];
+      }
+    }
+    if (best == nullptr) {
+      return false;
+    }
+    this->PopFrom(*best, out);
+    return true;
+  }
+
+private:
+  std::size_t shard_count_;
+  bool strict_;
+  std::unique_ptr<Shard[]> shards_;
+  Compare comp_;
+  alignas(kCacheLineSize) std::atomic<std::ptrdiff_t> size_{0};
+};
+
+}
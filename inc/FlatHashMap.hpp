@@ -0,0 +1,955 @@
+#pragma once
+
+#include "Hash.hpp"
+#include "Utility.hpp"
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tystl {
+
+// The table behind FlatHashMap and FlatHashSet, in the style of the Swiss
+// table: one control byte per slot says whether the slot is empty, erased or
+// full, and a full slot keeps 7 bits of its hash there. Lookups compare the
+// control bytes of 16 slots at once and only look at the slots whose bits
+// match.
+namespace flat_hash_detail {
+
+using Ctrl = std::int8_t;
+
+// Empty and deleted have the top bit set and full bytes do not, so one
+// movemask finds every free slot of a group. The sentinel after the last
+// slot stops iteration.
+inline constexpr Ctrl kEmpty = -128;
+inline constexpr Ctrl kDeleted = -2;
+inline constexpr Ctrl kSentinel = -1;
+
+inline constexpr std::size_t kGroupWidth = 16;
+
+// Control bytes of a table without slots, so lookups need no special case.
+inline constexpr Ctrl kEmptyGroup[kGroupWidth] = {
+  kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+  kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+};
+
+// The high bits of the hash pick the group a probe starts at, the low 7
+// bits go into the control byte.
+inline std::size_t H1(std::size_t hash) noexcept {
+  return hash >> 7;
+}
+
+inline Ctrl H2(std::size_t hash) noexcept {
+  return static_cast<Ctrl>(hash & 0x7f);
+}
+
+// The control bytes of 16 slots. Every match returns one bit per slot.
+class Group {
+public:
+  explicit Group(const Ctrl *ctrl) noexcept {
+#if defined(__SSE2__)
+    ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+    std::memcpy(ctrl_, ctrl, kGroupWidth);
+#endif
+  }
+
+  std::uint32_t Match(Ctrl h2) const noexcept {
+#if defined(__SSE2__)
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+    return this->MatchIf([h2](Ctrl ctrl) { return ctrl == h2; });
+#endif
+  }
+
+  std::uint32_t MatchEmpty() const noexcept {
+    return this->Match(kEmpty);
+  }
+
+  std::uint32_t MatchEmptyOrDeleted() const noexcept {
+#if defined(__SSE2__)
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+    return this->MatchIf([](Ctrl ctrl) { return ctrl < 0; });
+#endif
+  }
+
+private:
+#if defined(__SSE2__)
+  __m128i ctrl_;
+#else
+  template <typename Pred>
+  std::uint32_t MatchIf(Pred pred) const noexcept {
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < kGroupWidth; i ++) {
+      bits |= static_cast<std::uint32_t>(pred(ctrl_[i])) << i;
+    }
+    return bits;
+  }
+
+  Ctrl ctrl_[kGroupWidth];
+#endif
+};
+
+template <typename K, typename V>
+struct MapPolicy {
+  using key_type = K;
+  using value_type = std::pair<const K, V>;
+
+  static constexpr bool kNothrowMove =
+    std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>;
+
+  static const K& Key(const value_type &value) noexcept {
+    return value.first;
+  }
+
+  // The key is const to users only. The table owns the slot and destroys
+  // 'from' right after, so moving out of the key is safe.
+  template <typename Alloc>
+  static void Move(Alloc &alloc, value_type *to, value_type *from) noexcept(kNothrowMove) {
+    std::allocator_traits<Alloc>::construct(alloc, to, std::piecewise_construct,
+                                            std::forward_as_tuple(tystl::Move(const_cast<K&>(from->first))),
+                                            std::forward_as_tuple(tystl::Move(from->second)));
+  }
+};
+
+template <typename K>
+struct SetPolicy {
+  using key_type = K;
+  using value_type = K;
+
+  static constexpr bool kNothrowMove = std::is_nothrow_move_constructible_v<K>;
+
+  static const K& Key(const value_type &value) noexcept {
+    return value;
+  }
+
+  template <typename Alloc>
+  static void Move(Alloc &alloc, value_type *to, value_type *from) noexcept(kNothrowMove) {
+    std::allocator_traits<Alloc>::construct(alloc, to, tystl::Move(*from));
+  }
+};
+
+template <typename Hash, typename Eq>
+inline constexpr bool kTransparent = requires {
+  typename Hash::is_transparent;
+  typename Eq::is_transparent;
+};
+
+// Iterates the full slots of a table in slot order. 'kConst' picks the
+// reference type; a set only ever hands out const references.
+template <typename Value, bool kConst>
+class Iterator {
+  template <typename, typename, typename, typename>
+  friend class RawTable;
+
+  template <typename, bool>
+  friend class Iterator;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = std::remove_const_t<Value>;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = std::conditional_t<kConst, const Value*, Value*>;
+  using reference         = std::conditional_t<kConst, const Value&, Value&>;
+
+public:
+  Iterator() noexcept = default;
+
+  template <bool kOtherConst>
+    requires (kConst && !kOtherConst)
+  Iterator(const Iterator<Value, kOtherConst> &other) noexcept : ctrl_(other.ctrl_), slot_(other.slot_) {}
+
+  reference operator*() const noexcept {
+    return *slot_;
+  }
+
+  pointer operator->() const noexcept {
+    return slot_;
+  }
+
+  Iterator& operator++() noexcept {
+    ++ctrl_;
+    ++slot_;
+    this->SkipFree();
+    return *this;
+  }
+
+  Iterator operator++(int) noexcept {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  template <bool kOtherConst>
+  bool operator==(const Iterator<Value, kOtherConst> &other) const noexcept {
+    return ctrl_ == other.ctrl_;
+  }
+
+private:
+  Iterator(const Ctrl *ctrl, Value *slot) noexcept : ctrl_(ctrl), slot_(slot) {}
+
+  void SkipFree() noexcept {
+    while (*ctrl_ < kSentinel) {
+      ++ctrl_;
+      ++slot_;
+    }
+  }
+
+private:
+  const Ctrl *ctrl_ = nullptr;
+  Value *slot_ = nullptr;
+};
+
+// Open addressing over groups of 16 slots. The number of groups is a power
+// of two and probing visits them in triangular order, which reaches every
+// group. The load factor is kept under 7/8, counting erased slots, so every
+// probe ends at an empty slot.
+//
+// Erasing leaves a tombstone only if the slot's group has no empty slot:
+// a group with an empty slot was never full, so no probe went past it and
+// the slot can become empty again.
+template <typename Policy, typename Hash, typename Eq, typename Alloc>
+class RawTable {
+  using SlotAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<typename Policy::value_type>;
+  using SlotTraits = std::allocator_traits<SlotAlloc>;
+  using CtrlAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Ctrl>;
+  using CtrlTraits = std::allocator_traits<CtrlAlloc>;
+
+  static constexpr std::size_t kNotFound = ~std::size_t{0};
+
+  template <typename K>
+  static constexpr bool kKeyArg = std::same_as<K, typename Policy::key_type> || kTransparent<Hash, Eq>;
+
+public:
+  using key_type        = typename Policy::key_type;
+  using value_type      = typename Policy::value_type;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher          = Hash;
+  using key_equal       = Eq;
+  using allocator_type  = Alloc;
+  using reference       = value_type&;
+  using const_reference = const value_type&;
+  using iterator        = Iterator<value_type, std::is_same_v<key_type, value_type>>;
+  using const_iterator  = Iterator<value_type, true>;
+
+public:
+  RawTable() noexcept(noexcept(Hash()) && noexcept(Eq()) && noexcept(Alloc())) = default;
+
+  explicit RawTable(size_type capacity, const Hash &hash = Hash(), const Eq &eq = Eq(),
+                    const Alloc &alloc = Alloc())
+      : hash_(hash), eq_(eq), alloc_(alloc) {
+    this->Reserve(capacity);
+  }
+
+  explicit RawTable(const Alloc &alloc) : alloc_(alloc) {}
+
+  template <std::input_iterator InputIt>
+  RawTable(InputIt first, InputIt last, size_type capacity = 0, const Hash &hash = Hash(), const Eq &eq = Eq(),
+           const Alloc &alloc = Alloc())
+      : RawTable(capacity, hash, eq, alloc) {
+    this->Insert(first, last);
+  }
+
+  RawTable(std::initializer_list<value_type> init, size_type capacity = 0, const Hash &hash = Hash(),
+           const Eq &eq = Eq(), const Alloc &alloc = Alloc())
+      : RawTable(init.begin(), init.end(), capacity, hash, eq, alloc) {}
+
+  RawTable(const RawTable &other)
+      : hash_(other.hash_), eq_(other.eq_),
+        alloc_(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_)) {
+    this->CopyFrom(other);
+  }
+
+  RawTable(RawTable &&other) noexcept
+      : ctrl_(std::exchange(other.ctrl_, EmptyCtrl())),
+        slots_(std::exchange(other.slots_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        size_(std::exchange(other.size_, 0)),
+        growth_left_(std::exchange(other.growth_left_, 0)),
+        hash_(tystl::Move(other.hash_)),
+        eq_(tystl::Move(other.eq_)),
+        alloc_(tystl::Move(other.alloc_)) {}
+
+  RawTable& operator=(const RawTable &other) {
+    if (this == &other) {
+      return *this;
+    }
+    this->Clear();
+    if constexpr (std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value) {
+      if (alloc_ != other.alloc_) {
+        this->Deallocate();
+      }
+      alloc_ = other.alloc_;
+    }
+    hash_ = other.hash_;
+    eq_ = other.eq_;
+    this->CopyFrom(other);
+    return *this;
+  }
+
+  RawTable& operator=(RawTable &&other) noexcept(std::allocator_traits<Alloc>::is_always_equal::value ||
+                                                 std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value) {
+    if (this == &other) {
+      return *this;
+    }
+    using AllocTraits = std::allocator_traits<Alloc>;
+    if constexpr (!AllocTraits::propagate_on_container_move_assignment::value && !AllocTraits::is_always_equal::value) {
+      // Slots from another allocator cannot be adopted, move the elements.
+      if (alloc_ != other.alloc_) {
+        this->Clear();
+        hash_ = other.hash_;
+        eq_ = other.eq_;
+        this->Reserve(other.size_);
+        for (auto &value : other) {
+          this->InsertUnique(tystl::Move(value));
+        }
+        other.Clear();
+        return *this;
+      }
+    }
+    this->Destroy();
+    this->Deallocate();
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+      alloc_ = tystl::Move(other.alloc_);
+    }
+    ctrl_ = std::exchange(other.ctrl_, EmptyCtrl());
+    slots_ = std::exchange(other.slots_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    size_ = std::exchange(other.size_, 0);
+    growth_left_ = std::exchange(other.growth_left_, 0);
+    hash_ = tystl::Move(other.hash_);
+    eq_ = tystl::Move(other.eq_);
+    return *this;
+  }
+
+  ~RawTable() {
+    this->Destroy();
+    this->Deallocate();
+  }
+
+public:
+  iterator begin() noexcept {
+    if (size_ == 0) {
+      return this->end();
+    }
+    iterator it(ctrl_, slots_);
+    it.SkipFree();
+    return it;
+  }
+
+  const_iterator begin() const noexcept {
+    return const_cast<RawTable*>(this)->begin();
+  }
+
+  const_iterator cbegin() const noexcept {
+    return this->begin();
+  }
+
+  iterator end() noexcept {
+    return iterator(ctrl_ + capacity_, slots_ + capacity_);
+  }
+
+  const_iterator end() const noexcept {
+    return const_cast<RawTable*>(this)->end();
+  }
+
+  const_iterator cend() const noexcept {
+    return this->end();
+  }
+
+  [[nodiscard]]
+  size_type Size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]]
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]]
+  bool Empty() const noexcept {
+    return size_ == 0;
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  // The number of slots. At most 7/8 of them are used before the table grows.
+  [[nodiscard]]
+  size_type Capacity() const noexcept {
+    return capacity_;
+  }
+
+  [[nodiscard]]
+  float LoadFactor() const noexcept {
+    return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / static_cast<float>(capacity_);
+  }
+
+  [[nodiscard]]
+  Alloc GetAllocator() const noexcept {
+    return alloc_;
+  }
+
+  [[nodiscard]]
+  Hash HashFunction() const {
+    return hash_;
+  }
+
+  [[nodiscard]]
+  Eq KeyEq() const {
+    return eq_;
+  }
+
+  // Makes room for 'count' elements without another rehash.
+  void Reserve(size_type count) {
+    if (count <= size_ + growth_left_) {
+      return;
+    }
+    this->Resize(CapacityFor(count));
+  }
+
+  // Destroys the elements and keeps the slots.
+  void Clear() noexcept {
+    if (capacity_ == 0) {
+      return;
+    }
+    this->Destroy();
+    std::memset(ctrl_, static_cast<unsigned char>(kEmpty), capacity_);
+    size_ = 0;
+    growth_left_ = MaxLoad(capacity_);
+  }
+
+  template <typename K>
+    requires kKeyArg<K>
+  [[nodiscard]]
+  iterator Find(const K &key) {
+    return this->IteratorAt(this->FindIndex(key, hash_(key)));
+  }
+
+  template <typename K>
+    requires kKeyArg<K>
+  [[nodiscard]]
+  const_iterator Find(const K &key) const {
+    return const_cast<RawTable*>(this)->Find(key);
+  }
+
+  [[nodiscard]]
+  iterator Find(const key_type &key) {
+    return this->IteratorAt(this->FindIndex(key, hash_(key)));
+  }
+
+  [[nodiscard]]
+  const_iterator Find(const key_type &key) const {
+    return const_cast<RawTable*>(this)->Find(key);
+  }
+
+  template <typename K>
+    requires kKeyArg<K>
+  [[nodiscard]]
+  bool Contains(const K &key) const {
+    return this->FindIndex(key, hash_(key)) != kNotFound;
+  }
+
+  [[nodiscard]]
+  bool Contains(const key_type &key) const {
+    return this->FindIndex(key, hash_(key)) != kNotFound;
+  }
+
+  template <typename K>
+    requires kKeyArg<K>
+  [[nodiscard]]
+  size_type Count(const K &key) const {
+    return this->Contains(key);
+  }
+
+  [[nodiscard]]
+  size_type Count(const key_type &key) const {
+    return this->Contains(key);
+  }
+
+  std::pair<iterator, bool> Insert(const value_type &value) {
+    return this->EmplaceKey(Policy::Key(value), value);
+  }
+
+  std::pair<iterator, bool> Insert(value_type &&value) {
+    return this->EmplaceKey(Policy::Key(value), tystl::Move(value));
+  }
+
+  template <std::input_iterator InputIt>
+  void Insert(InputIt first, InputIt last) {
+    if constexpr (std::forward_iterator<InputIt>) {
+      this->Reserve(size_ + static_cast<size_type>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+      this->Insert(*first);
+    }
+  }
+
+  void Insert(std::initializer_list<value_type> init) {
+    this->Insert(init.begin(), init.end());
+  }
+
+  // Builds the value first to learn its key, then moves it into place if
+  // the key is new.
+  template <typename ...Args>
+  std::pair<iterator, bool> Emplace(Args &&...args) {
+    value_type value(tystl::Forward<Args>(args)...);
+    return this->EmplaceKey(Policy::Key(value), tystl::Move(value));
+  }
+
+  template <typename K>
+    requires kKeyArg<K>
+  size_type Erase(const K &key) {
+    auto index = this->FindIndex(key, hash_(key));
+    if (index == kNotFound) {
+      return 0;
+    }
+    this->EraseAt(index);
+    return 1;
+  }
+
+  size_type Erase(const key_type &key) {
+    auto index = this->FindIndex(key, hash_(key));
+    if (index == kNotFound) {
+      return 0;
+    }
+    this->EraseAt(index);
+    return 1;
+  }
+
+  // Returns the iterator to the element after 'pos'.
+  iterator Erase(const_iterator pos) {
+    auto index = static_cast<size_type>(pos.ctrl_ - ctrl_);
+    this->EraseAt(index);
+    iterator next(ctrl_ + index, slots_ + index);
+    next.SkipFree();
+    return next;
+  }
+
+  iterator Erase(iterator pos)
+    requires (!std::is_same_v<iterator, const_iterator>) {
+    return this->Erase(const_iterator(pos));
+  }
+
+  void Swap(RawTable &other) noexcept {
+    using tystl::Swap;
+    if constexpr (std::allocator_traits<Alloc>::propagate_on_container_swap::value) {
+      Swap(alloc_, other.alloc_);
+    }
+    Swap(ctrl_, other.ctrl_);
+    Swap(slots_, other.slots_);
+    Swap(capacity_, other.capacity_);
+    Swap(size_, other.size_);
+    Swap(growth_left_, other.growth_left_);
+    Swap(hash_, other.hash_);
+    Swap(eq_, other.eq_);
+  }
+
+protected:
+  template <typename K>
+  size_type FindIndex(const K &key, size_type hash) const {
+    auto h2 = H2(hash);
+    auto group = H1(hash) & this->GroupMask();
+    for (size_type step = 1;; step ++) {
+      Group ctrl(ctrl_ + group * kGroupWidth);
+      for (auto bits = ctrl.Match(h2); bits != 0; bits &= bits - 1) {
+        auto index = group * kGroupWidth + static_cast<size_type>(std::countr_zero(bits));
+        if (eq_(Policy::Key(slots_[index]), key)) [[likely]] {
+          return index;
+        }
+      }
+      if (ctrl.MatchEmpty() != 0) [[likely]] {
+        return kNotFound;
+      }
+      group = (group + step) & this->GroupMask();
+    }
+  }
+
+  // Finds 'key' or inserts 'make_value(slot)' for it, where 'make_value'
+  // constructs the new value in the uninitialized 'slot'.
+  template <typename K, typename MakeValue>
+  std::pair<iterator, bool> FindOrInsert(const K &key, MakeValue &&make_value) {
+    auto hash = hash_(key);
+    auto index = this->FindIndex(key, hash);
+    if (index != kNotFound) {
+      return {this->IteratorAt(index), false};
+    }
+    index = this->PrepareInsert(hash);
+    make_value(slots_ + index);
+    this->SetCtrl(index, H2(hash));
+    size_ ++;
+    return {this->IteratorAt(index), true};
+  }
+
+  template <typename K, typename ...Args>
+  std::pair<iterator, bool> EmplaceKey(const K &key, Args &&...args) {
+    return this->FindOrInsert(key, [&](value_type *slot) {
+      this->ConstructAt(slot, tystl::Forward<Args>(args)...);
+    });
+  }
+
+  iterator IteratorAt(size_type index) noexcept {
+    if (index == kNotFound) {
+      return this->end();
+    }
+    return iterator(ctrl_ + index, slots_ + index);
+  }
+
+  template <typename ...Args>
+  void ConstructAt(value_type *slot, Args &&...args) {
+    auto alloc = this->SlotAllocator();
+    SlotTraits::construct(alloc, slot, tystl::Forward<Args>(args)...);
+  }
+
+private:
+  // Never written through: a table without slots grows before its first
+  // insert.
+  static Ctrl* EmptyCtrl() noexcept {
+    return const_cast<Ctrl*>(kEmptyGroup);
+  }
+
+  static size_type MaxLoad(size_type capacity) noexcept {
+    return capacity - capacity / 8;
+  }
+
+  // The smallest power of two number of groups whose load limit fits 'count'.
+  static size_type CapacityFor(size_type count) noexcept {
+    auto capacity = std::bit_ceil(count + (count + 6) / 7);
+    return capacity < kGroupWidth ? kGroupWidth : capacity;
+  }
+
+  size_type GroupMask() const noexcept {
+    return capacity_ == 0 ? 0 : capacity_ / kGroupWidth - 1;
+  }
+
+  SlotAlloc SlotAllocator() const noexcept {
+    return SlotAlloc(alloc_);
+  }
+
+  void SetCtrl(size_type index, Ctrl ctrl) noexcept {
+    ctrl_[index] = ctrl;
+  }
+
+  // The first empty or erased slot on the probe sequence of 'hash'.
+  size_type FindFreeSlot(size_type hash) const noexcept {
+    auto group = H1(hash) & this->GroupMask();
+    for (size_type step = 1;; step ++) {
+      auto bits = Group(ctrl_ + group * kGroupWidth).MatchEmptyOrDeleted();
+      if (bits != 0) {
+        return group * kGroupWidth + static_cast<size_type>(std::countr_zero(bits));
+      }
+      group = (group + step) & this->GroupMask();
+    }
+  }
+
+  // Returns a free slot for 'hash', growing the table if it would pass its
+  // load limit. Reusing an erased slot never grows it.
+  size_type PrepareInsert(size_type hash) {
+    auto index = this->FindFreeSlot(hash);
+    if (growth_left_ == 0 && ctrl_[index] == kEmpty) [[unlikely]] {
+      this->Grow();
+      index = this->FindFreeSlot(hash);
+    }
+    growth_left_ -= ctrl_[index] == kEmpty;
+    return index;
+  }
+
+  // Doubles the capacity, or rehashes at the same capacity if erased slots
+  // rather than elements used up the load limit.
+  void Grow() {
+    if (capacity_ == 0) {
+      this->Resize(kGroupWidth);
+    } else if (size_ <= MaxLoad(capacity_) / 2) {
+      this->Resize(capacity_);
+    } else {
+      this->Resize(capacity_ * 2);
+    }
+  }
+
+  void EraseAt(size_type index) noexcept {
+    auto alloc = this->SlotAllocator();
+    SlotTraits::destroy(alloc, slots_ + index);
+    size_ --;
+    auto group = index & ~(kGroupWidth - 1);
+    if (Group(ctrl_ + group).MatchEmpty() != 0) {
+      this->SetCtrl(index, kEmpty);
+      growth_left_ ++;
+    } else {
+      this->SetCtrl(index, kDeleted);
+    }
+  }
+
+  // Moves the elements into 'capacity' new slots. If moving may throw, the
+  // elements are copied instead and the table is unchanged on failure.
+  // Hashing is assumed not to throw.
+  void Resize(size_type capacity) {
+    auto ctrl_alloc = CtrlAlloc(alloc_);
+    auto slot_alloc = this->SlotAllocator();
+    auto *new_ctrl = CtrlTraits::allocate(ctrl_alloc, capacity + 1);
+    value_type *new_slots;
+    try {
+      new_slots = SlotTraits::allocate(slot_alloc, capacity);
+    } catch (...) {
+      CtrlTraits::deallocate(ctrl_alloc, new_ctrl, capacity + 1);
+      throw;
+    }
+    std::memset(new_ctrl, static_cast<unsigned char>(kEmpty), capacity);
+    new_ctrl[capacity] = kSentinel;
+
+    auto *old_ctrl = ctrl_;
+    auto *old_slots = slots_;
+    auto old_capacity = capacity_;
+    ctrl_ = new_ctrl;
+    slots_ = new_slots;
+    capacity_ = capacity;
+    growth_left_ = MaxLoad(capacity) - size_;
+    if (old_capacity == 0) {
+      return;
+    }
+
+    auto transfer = [&](auto &&place) {
+      for (size_type i = 0; i < old_capacity; i ++) {
+        if (old_ctrl[i] >= 0) {
+          auto hash = hash_(Policy::Key(old_slots[i]));
+          auto index = this->FindFreeSlot(hash);
+          place(new_slots + index, old_slots + i);
+          this->SetCtrl(index, H2(hash));
+        }
+      }
+    };
+    if constexpr (IsTriviallyRelocatableValue<value_type>) {
+      transfer([](value_type *to, value_type *from) {
+        std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), sizeof(value_type));
+      });
+    } else if constexpr (Policy::kNothrowMove) {
+      transfer([&](value_type *to, value_type *from) {
+        Policy::Move(slot_alloc, to, from);
+        SlotTraits::destroy(slot_alloc, from);
+      });
+    } else {
+      try {
+        transfer([&](value_type *to, value_type *from) {
+          SlotTraits::construct(slot_alloc, to, std::as_const(*from));
+        });
+      } catch (...) {
+        this->Destroy();
+        SlotTraits::deallocate(slot_alloc, new_slots, capacity);
+        CtrlTraits::deallocate(ctrl_alloc, new_ctrl, capacity + 1);
+        ctrl_ = old_ctrl;
+        slots_ = old_slots;
+        capacity_ = old_capacity;
+        growth_left_ = MaxLoad(old_capacity) - size_;
+        throw;
+      }
+      for (size_type i = 0; i < old_capacity; i ++) {
+        if (old_ctrl[i] >= 0) {
+          SlotTraits::destroy(slot_alloc, old_slots + i);
+        }
+      }
+    }
+    SlotTraits::deallocate(slot_alloc, old_slots, old_capacity);
+    CtrlTraits::deallocate(ctrl_alloc, old_ctrl, old_capacity + 1);
+  }
+
+  // Inserts a value known not to be present.
+  template <typename Value>
+  void InsertUnique(Value &&value) {
+    auto hash = hash_(Policy::Key(value));
+    auto index = this->PrepareInsert(hash);
+    auto alloc = this->SlotAllocator();
+    SlotTraits::construct(alloc, slots_ + index, tystl::Forward<Value>(value));
+    this->SetCtrl(index, H2(hash));
+    size_ ++;
+  }
+
+  void CopyFrom(const RawTable &other) {
+    this->Reserve(other.size_);
+    for (const auto &value : other) {
+      this->InsertUnique(value);
+    }
+  }
+
+  void Destroy() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+      auto alloc = this->SlotAllocator();
+      for (size_type i = 0; i < capacity_; i ++) {
+        if (ctrl_[i] >= 0) {
+          SlotTraits::destroy(alloc, slots_ + i);
+        }
+      }
+    }
+  }
+
+  void Deallocate() noexcept {
+    if (capacity_ == 0) {
+      return;
+    }
+    auto ctrl_alloc = CtrlAlloc(alloc_);
+    auto slot_alloc = this->SlotAllocator();
+    SlotTraits::deallocate(slot_alloc, slots_, capacity_);
+    CtrlTraits::deallocate(ctrl_alloc, ctrl_, capacity_ + 1);
+    ctrl_ = EmptyCtrl();
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    growth_left_ = 0;
+  }
+
+private:
+  Ctrl *ctrl_ = EmptyCtrl();
+  value_type *slots_ = nullptr;
+  size_type capacity_ = 0;
+  size_type size_ = 0;
+  // Empty slots that may still be filled before the table must grow.
+  size_type growth_left_ = 0;
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] Eq eq_;
+  [[no_unique_address]] Alloc alloc_;
+};
+
+template <typename Policy, typename Hash, typename Eq, typename Alloc>
+bool operator==(const RawTable<Policy, Hash, Eq, Alloc> &left, const RawTable<Policy, Hash, Eq, Alloc> &right) {
+  if (left.Size() != right.Size()) {
+    return false;
+  }
+  for (const auto &value : left) {
+    auto found = right.Find(Policy::Key(value));
+    if (found == right.end() || !(*found == value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace flat_hash_detail
+
+// A hash map that stores its keys and values inline in one flat array of
+// slots (see flat_hash_detail::RawTable). Compared with
+// std::unordered_map, a lookup touches one cache line of control bytes and
+// usually one slot, with no node to chase.
+//
+// Inserting may rehash, which moves elements and invalidates iterators and
+// references; erasing invalidates only the erased element. Lookups with
+// another key type, e.g. a string_view into a map keyed by std::string,
+// work when both 'Hash' and 'Eq' declare 'is_transparent', as the
+// defaults do for strings.
+template <typename K, typename V, typename Hash = DefaultHash<K>, typename Eq = std::equal_to<>,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+class FlatHashMap : public flat_hash_detail::RawTable<flat_hash_detail::MapPolicy<K, V>, Hash, Eq, Alloc> {
+  using Base = flat_hash_detail::RawTable<flat_hash_detail::MapPolicy<K, V>, Hash, Eq, Alloc>;
+
+public:
+  using mapped_type = V;
+  using typename Base::iterator;
+  using typename Base::const_iterator;
+  using typename Base::key_type;
+  using typename Base::value_type;
+
+public:
+  using Base::Base;
+
+public:
+  // Constructs the value from 'args' only if 'key' is not present.
+  template <typename ...Args>
+  std::pair<iterator, bool> TryEmplace(const key_type &key, Args &&...args) {
+    return this->TryEmplaceImpl(key, tystl::Forward<Args>(args)...);
+  }
+
+  template <typename ...Args>
+  std::pair<iterator, bool> TryEmplace(key_type &&key, Args &&...args) {
+    return this->TryEmplaceImpl(tystl::Move(key), tystl::Forward<Args>(args)...);
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> InsertOrAssign(const key_type &key, M &&value) {
+    auto [it, inserted] = this->TryEmplace(key, tystl::Forward<M>(value));
+    if (!inserted) {
+      it->second = tystl::Forward<M>(value);
+    }
+    return {it, inserted};
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> InsertOrAssign(key_type &&key, M &&value) {
+    auto [it, inserted] = this->TryEmplace(tystl::Move(key), tystl::Forward<M>(value));
+    if (!inserted) {
+      it->second = tystl::Forward<M>(value);
+    }
+    return {it, inserted};
+  }
+
+  V& operator[](const key_type &key) {
+    return this->TryEmplace(key).first->second;
+  }
+
+  V& operator[](key_type &&key) {
+    return this->TryEmplace(tystl::Move(key)).first->second;
+  }
+
+  // Throws std::out_of_range if 'key' is not present.
+  template <typename Key>
+  [[nodiscard]]
+  V& At(const Key &key) {
+    auto found = this->Find(key);
+    if (found == this->end()) {
+      throw std::out_of_range("FlatHashMap::At: key not found");
+    }
+    return found->second;
+  }
+
+  template <typename Key>
+  [[nodiscard]]
+  const V& At(const Key &key) const {
+    return const_cast<FlatHashMap*>(this)->At(key);
+  }
+
+private:
+  template <typename Key, typename ...Args>
+  std::pair<iterator, bool> TryEmplaceImpl(Key &&key, Args &&...args) {
+    return this->FindOrInsert(key, [&](value_type *slot) {
+      this->ConstructAt(slot, std::piecewise_construct, std::forward_as_tuple(tystl::Forward<Key>(key)),
+                        std::forward_as_tuple(tystl::Forward<Args>(args)...));
+    });
+  }
+};
+
+// A hash set over the same table as FlatHashMap. Elements are constant,
+// so 'iterator' and 'const_iterator' are the same type.
+template <typename K, typename Hash = DefaultHash<K>, typename Eq = std::equal_to<>,
+          typename Alloc = std::allocator<K>>
+class FlatHashSet : public flat_hash_detail::RawTable<flat_hash_detail::SetPolicy<K>, Hash, Eq, Alloc> {
+  using Base = flat_hash_detail::RawTable<flat_hash_detail::SetPolicy<K>, Hash, Eq, Alloc>;
+
+public:
+  using Base::Base;
+};
+
+template <typename K, typename V, typename Hash, typename Eq, typename Alloc>
+void Swap(FlatHashMap<K, V, Hash, Eq, Alloc> &left, FlatHashMap<K, V, Hash, Eq, Alloc> &right) noexcept {
+  left.Swap(right);
+}
+
+template <typename K, typename Hash, typename Eq, typename Alloc>
+void Swap(FlatHashSet<K, Hash, Eq, Alloc> &left, FlatHashSet<K, Hash, Eq, Alloc> &right) noexcept {
+  left.Swap(right);
+}
+
+}
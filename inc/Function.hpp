@@ -0,0 +1,332 @@
+#pragma once
+
+#include "Concept.hpp"
+#include "Instrument.hpp"
+#include "Pool.hpp"
+#include "Utility.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tystl {
+
+// Inline bytes of a Function or MoveOnlyFunction unless told otherwise,
+// enough for a lambda that captures three pointers.
+inline constexpr std::size_t kFunctionInlineSize = 3 * sizeof(void*);
+
+namespace function_detail {
+
+template <typename Signature, std::size_t InlineSize, bool kCopyable>
+class BasicFunction;
+
+// Holds any callable with the signature 'R(Args...)', stored the way Any
+// stores its values: targets of at most 'InlineSize' bytes, aligned to at
+// most 'kInlineAlign', whose move constructor cannot throw live inside the
+// object, everything else in a block from the thread-caching Pool.
+//
+// The call goes through a function pointer kept in the object itself, so
+// it is one indirect call. Moving, copying and destroying go through a
+// table per target type; trivially copyable inline targets need none of it
+// and are moved as bytes. Moves never throw.
+template <typename R, typename ...Args, std::size_t InlineSize, bool kCopyable>
+class BasicFunction<R(Args...), InlineSize, kCopyable> {
+  static_assert(InlineSize >= sizeof(void*), "the inline buffer also holds the heap pointer");
+
+public:
+  static constexpr std::size_t kInlineSize = InlineSize;
+
+  static constexpr std::size_t kInlineAlign = alignof(void*);
+
+  template <typename T>
+  static constexpr bool IsInline = sizeof(T) <= kInlineSize
+                                && alignof(T) <= kInlineAlign
+                                && std::is_nothrow_move_constructible_v<T>;
+
+private:
+  union Storage {
+    void *heap;
+    alignas(kInlineAlign) unsigned char buffer[kInlineSize];
+  };
+
+  using Invoker = R (*)(Storage &storage, Args &&...args);
+
+  struct Operations {
+    void (*destroy)(Storage &self) noexcept;
+    void (*copy)(const Storage &from, Storage &to);
+    void (*move)(Storage &from, Storage &to) noexcept;
+  };
+
+  // Marks targets that are copied and dropped as plain bytes.
+  static constexpr Operations kTrivialOperations{nullptr, nullptr, nullptr};
+
+  template <typename T>
+  struct Handler {
+    static constexpr bool kTrivial = IsInline<T>
+                                  && std::is_trivially_copyable_v<T>
+                                  && std::is_trivially_destructible_v<T>;
+
+    [[nodiscard]]
+    static T* Get(const Storage &storage) noexcept {
+      if constexpr (IsInline<T>) {
+        return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(storage.buffer)));
+      } else {
+        return static_cast<T*>(storage.heap);
+      }
+    }
+
+    template <typename ...Ts>
+    static void Construct(Storage &storage, Ts &&...args) {
+      if constexpr (IsInline<T>) {
+        ::new (static_cast<void*>(storage.buffer)) T(tystl::Forward<Ts>(args)...);
+      } else {
+        void *ptr = Pool::Allocate(sizeof(T), alignof(T));
+        instrument::CountAllocation<T>(sizeof(T));
+        try {
+          storage.heap = ::new (ptr) T(tystl::Forward<Ts>(args)...);
+        } catch (...) {
+          Pool::Deallocate(ptr, sizeof(T), alignof(T));
+          throw;
+        }
+      }
+    }
+
+    template <typename ...Ts>
+    static void MakeData(BasicFunction &self, Ts &&...args) {
+      Construct(self.storage_, tystl::Forward<Ts>(args)...);
+      self.invoke_ = &Invoke;
+      self.operations_ = kTrivial ? &kTrivialOperations : &kOperations;
+    }
+
+    static R Invoke(Storage &storage, Args &&...args) {
+      return std::invoke_r<R>(*Get(storage), tystl::Forward<Args>(args)...);
+    }
+
+    static void Destroy(Storage &storage) noexcept {
+      std::destroy_at(Get(storage));
+      if constexpr (!IsInline<T>) {
+        Pool::Deallocate(storage.heap, sizeof(T), alignof(T));
+      }
+    }
+
+    static void Copy(const Storage &from, Storage &to) {
+      Construct(to, *Get(from));
+    }
+
+    static void Move(Storage &from, Storage &to) noexcept {
+      if constexpr (IsInline<T>) {
+        ::new (static_cast<void*>(to.buffer)) T(tystl::Move(*Get(from)));
+        std::destroy_at(Get(from));
+      } else {
+        to.heap = from.heap;
+      }
+    }
+
+    static constexpr auto CopyOperation() noexcept {
+      if constexpr (kCopyable) {
+        return &Copy;
+      } else {
+        return static_cast<void (*)(const Storage&, Storage&)>(nullptr);
+      }
+    }
+
+    static constexpr Operations kOperations{&Destroy, CopyOperation(), &Move};
+  };
+
+  [[noreturn]]
+  static R InvokeEmpty(Storage &, Args &&...) {
+    throw std::bad_function_call();
+  }
+
+public:
+  BasicFunction() noexcept = default;
+
+  BasicFunction(std::nullptr_t) noexcept {}
+
+  // A null function or member pointer makes an empty function.
+  template <typename F>
+    requires (!SameAs<std::remove_cvref_t<F>, BasicFunction>)
+          && std::is_constructible_v<std::decay_t<F>, F>
+          && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+          && (!kCopyable || std::is_copy_constructible_v<std::decay_t<F>>)
+  BasicFunction(F &&func) {
+    using T = std::decay_t<F>;
+    // A function name decays to a pointer here but is never null.
+    if constexpr (std::is_pointer_v<std::remove_cvref_t<F>> || std::is_member_pointer_v<std::remove_cvref_t<F>>) {
+      if (func == nullptr) {
+        return;
+      }
+    }
+    Handler<T>::MakeData(*this, tystl::Forward<F>(func));
+  }
+
+  BasicFunction(const BasicFunction &other) requires kCopyable {
+    this->CopyFrom(other);
+  }
+
+  BasicFunction(const BasicFunction &other) requires (!kCopyable) = delete;
+
+  BasicFunction(BasicFunction &&other) noexcept {
+    this->MoveFrom(other);
+  }
+
+  BasicFunction& operator=(const BasicFunction &other) requires kCopyable {
+    if (this != &other) {
+      BasicFunction tmp = other;
+      this->Reset();
+      this->MoveFrom(tmp);
+    }
+    return *this;
+  }
+
+  BasicFunction& operator=(const BasicFunction &other) requires (!kCopyable) = delete;
+
+  BasicFunction& operator=(BasicFunction &&other) noexcept {
+    if (this != &other) {
+      this->Reset();
+      this->MoveFrom(other);
+    }
+    return *this;
+  }
+
+  BasicFunction& operator=(std::nullptr_t) noexcept {
+    this->Reset();
+    return *this;
+  }
+
+  ~BasicFunction() {
+    this->Reset();
+  }
+
+  void Swap(BasicFunction &other) noexcept {
+    BasicFunction tmp = tystl::Move(other);
+    other = tystl::Move(*this);
+    *this = tystl::Move(tmp);
+  }
+
+  [[nodiscard]]
+  bool HasValue() const noexcept {
+    return operations_ != nullptr;
+  }
+
+  explicit operator bool() const noexcept {
+    return this->HasValue();
+  }
+
+  void Reset() noexcept {
+    if (operations_ != nullptr && operations_ != &kTrivialOperations) {
+      operations_->destroy(storage_);
+    }
+    invoke_ = &InvokeEmpty;
+    operations_ = nullptr;
+  }
+
+  // Calls the target as an lvalue, like std::function. Throws
+  // std::bad_function_call if there is none.
+  R operator()(Args ...args) const requires kCopyable {
+    return invoke_(storage_, tystl::Forward<Args>(args)...);
+  }
+
+  R operator()(Args ...args) requires (!kCopyable) {
+    return invoke_(storage_, tystl::Forward<Args>(args)...);
+  }
+
+private:
+  void CopyFrom(const BasicFunction &other) {
+    if (other.operations_ == &kTrivialOperations) {
+      storage_ = other.storage_;
+    } else if (other.operations_ != nullptr) {
+      other.operations_->copy(other.storage_, storage_);
+    }
+    invoke_ = other.invoke_;
+    operations_ = other.operations_;
+  }
+
+  // Takes the target of 'other', which is left empty.
+  void MoveFrom(BasicFunction &other) noexcept {
+    if (other.operations_ == &kTrivialOperations) {
+      storage_ = other.storage_;
+    } else if (other.operations_ != nullptr) {
+      other.operations_->move(other.storage_, storage_);
+    }
+    invoke_ = std::exchange(other.invoke_, &InvokeEmpty);
+    operations_ = std::exchange(other.operations_, nullptr);
+  }
+
+private:
+  Invoker invoke_ = &InvokeEmpty;
+  const Operations *operations_ = nullptr;
+  // Mutable because a const Function still calls its target as non-const.
+  mutable Storage storage_;
+};
+
+} // namespace function_detail
+
+// A copyable callable wrapper, std::function with a configurable inline
+// buffer.
+template <typename Signature, std::size_t InlineSize = kFunctionInlineSize>
+using Function = function_detail::BasicFunction<Signature, InlineSize, true>;
+
+// Like Function, for targets that cannot be copied, such as lambdas that
+// own a UniquePtr.
+template <typename Signature, std::size_t InlineSize = kFunctionInlineSize>
+using MoveOnlyFunction = function_detail::BasicFunction<Signature, InlineSize, false>;
+
+static_assert(sizeof(Function<void()>) == 2 * sizeof(void*) + kFunctionInlineSize);
+
+template <typename Signature>
+class FunctionRef;
+
+// A non-owning reference to a callable, two pointers wide, for parameters
+// that are called before the function returns. It must not outlive the
+// callable it was made from; a function pointer is copied in instead.
+template <typename R, typename ...Args>
+class FunctionRef<R(Args...)> {
+public:
+  template <typename F>
+    requires (!SameAs<std::remove_cvref_t<F>, FunctionRef>)
+          && std::is_invocable_r_v<R, F&, Args...>
+  FunctionRef(F &&func) noexcept {
+    using T = std::remove_reference_t<F>;
+    if constexpr (std::is_function_v<T>) {
+      target_.function = reinterpret_cast<void (*)()>(&func);
+      invoke_ = [](Target target, Args &&...args) -> R {
+        return std::invoke_r<R>(reinterpret_cast<T*>(target.function), tystl::Forward<Args>(args)...);
+      };
+    } else if constexpr (std::is_pointer_v<std::remove_cv_t<T>> &&
+                         std::is_function_v<std::remove_pointer_t<std::remove_cv_t<T>>>) {
+      // The pointer is often a temporary, so it is kept by value.
+      using Pointer = std::remove_cv_t<T>;
+      target_.function = reinterpret_cast<void (*)()>(func);
+      invoke_ = [](Target target, Args &&...args) -> R {
+        return std::invoke_r<R>(reinterpret_cast<Pointer>(target.function), tystl::Forward<Args>(args)...);
+      };
+    } else {
+      target_.object = const_cast<void*>(static_cast<const void*>(std::addressof(func)));
+      invoke_ = [](Target target, Args &&...args) -> R {
+        return std::invoke_r<R>(*static_cast<T*>(target.object), tystl::Forward<Args>(args)...);
+      };
+    }
+  }
+
+  FunctionRef(const FunctionRef &) noexcept = default;
+
+  FunctionRef& operator=(const FunctionRef &) noexcept = default;
+
+  R operator()(Args ...args) const {
+    return invoke_(target_, tystl::Forward<Args>(args)...);
+  }
+
+private:
+  union Target {
+    void *object;
+    void (*function)();
+  };
+
+  Target target_;
+  R (*invoke_)(Target target, Args &&...args);
+};
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace tystl {
+
+// Grows a buffer's capacity by 'Num / Den' when it runs out. A factor below
+// two lets a freed block be reused by a later growth of the same buffer,
+// a larger one reallocates less often. Starts at 'Min' elements.
+//
+// A growth policy provides
+//
+//   static constexpr std::size_t Grow(std::size_t capacity, std::size_t required) noexcept;
+//
+// returning the capacity to move to when 'required' elements do not fit in
+// 'capacity'. The result must be at least 'required'.
+template <std::size_t Num = 3, std::size_t Den = 2, std::size_t Min = 4>
+  requires (Num > Den) && (Den > 0)
+struct GeometricGrowth {
+  static constexpr std::size_t Grow(std::size_t capacity, std::size_t required) noexcept {
+    auto grown = capacity < Min ? Min : capacity + capacity / Den * (Num - Den);
+    return std::max(grown, required);
+  }
+};
+
+using DefaultGrowth = GeometricGrowth<>;
+
+}
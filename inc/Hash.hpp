@@ -0,0 +1,118 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace tystl {
+
+namespace hash_detail {
+
+inline constexpr std::uint64_t kSecret0 = 0xa0761d6478bd642fULL;
+inline constexpr std::uint64_t kSecret1 = 0xe7037ed1a0b428dbULL;
+inline constexpr std::uint64_t kSecret2 = 0x8ebc6af09c88c6e3ULL;
+
+// 64x64 -> 128 bit multiply, folded back to 64 bits.
+inline std::uint64_t Mix(std::uint64_t left, std::uint64_t right) noexcept {
+  auto product = static_cast<unsigned __int128>(left) * right;
+  return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+}
+
+inline std::uint64_t Load64(const unsigned char *data) noexcept {
+  std::uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline std::uint64_t Load32(const unsigned char *data) noexcept {
+  std::uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+} // namespace hash_detail
+
+// Hashes 'size' bytes at 'data', 16 bytes per multiply (wyhash style). Not
+// meant to resist deliberate collisions.
+inline std::uint64_t HashBytes(const void *data, std::size_t size, std::uint64_t seed = 0) noexcept {
+  using namespace hash_detail;
+
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  auto state = seed ^ Mix(seed ^ kSecret0, kSecret1);
+  auto remaining = size;
+  while (remaining > 16) {
+    state = Mix(Load64(bytes) ^ kSecret1, Load64(bytes + 8) ^ state);
+    bytes += 16;
+    remaining -= 16;
+  }
+
+  std::uint64_t low = 0;
+  std::uint64_t high = 0;
+  if (remaining >= 8) {
+    low = Load64(bytes);
+    high = Load64(bytes + remaining - 8);
+  } else if (remaining >= 4) {
+    low = Load32(bytes);
+    high = Load32(bytes + remaining - 4);
+  } else if (remaining > 0) {
+    low = (std::uint64_t{bytes[0]} << 16) | (std::uint64_t{bytes[remaining / 2]} << 8) | bytes[remaining - 1];
+  }
+  return Mix(kSecret2 ^ size, Mix(low ^ kSecret1, high ^ state));
+}
+
+// Folds 'value' into 'seed', for hashing sequences element by element.
+inline std::uint64_t HashCombine(std::uint64_t seed, std::uint64_t value) noexcept {
+  return hash_detail::Mix(seed ^ hash_detail::kSecret0, value ^ hash_detail::kSecret1);
+}
+
+// Spreads an integer over all 64 bits, so that both the low and the high
+// bits of the result depend on every input bit.
+inline std::uint64_t HashInt(std::uint64_t value) noexcept {
+  return hash_detail::Mix(value ^ hash_detail::kSecret0, hash_detail::kSecret1);
+}
+
+// The hasher of the tystl hash containers. Unlike std::hash it mixes
+// integers and pointers, since the containers use both ends of the hash.
+// Types with a 'Hash()' member use it; anything else goes through
+// std::hash and is mixed the same way.
+template <typename T>
+struct DefaultHash {
+  std::size_t operator()(const T &value) const noexcept {
+    if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+      return static_cast<std::size_t>(HashInt(static_cast<std::uint64_t>(value)));
+    } else if constexpr (std::is_pointer_v<T>) {
+      return static_cast<std::size_t>(HashInt(reinterpret_cast<std::uintptr_t>(value)));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      // +0.0 and -0.0 compare equal, so they must hash alike.
+      return value == T(0) ? HashInt(0) : HashBytes(&value, sizeof(value));
+    } else if constexpr (requires { { value.Hash() } -> std::convertible_to<std::size_t>; }) {
+      return static_cast<std::size_t>(value.Hash());
+    } else {
+      return static_cast<std::size_t>(HashInt(std::hash<T>{}(value)));
+    }
+  }
+};
+
+// Strings hash their characters and accept any string-like argument, so a
+// container keyed by std::string can be searched with a string_view or a
+// literal without building a std::string.
+struct StringHash {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view value) const noexcept {
+    return static_cast<std::size_t>(HashBytes(value.data(), value.size()));
+  }
+};
+
+template <>
+struct DefaultHash<std::string> : StringHash {};
+
+template <>
+struct DefaultHash<std::string_view> : StringHash {};
+
+}
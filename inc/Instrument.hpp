@@ -0,0 +1,327 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Opt-in counters for allocations, reference counting and heap work. They
+// are compiled in only when TYSTL_INSTRUMENT is defined to a non-zero value
+// (e.g. 'add_defines("TYSTL_INSTRUMENT=1")'); otherwise every counting call
+// is an empty inline function and the snapshot API reports zeros.
+//
+// Each thread counts into its own block without atomic read-modify-write
+// instructions. 'TakeSnapshot' adds up the blocks of the running threads and
+// the totals left by finished ones.
+#ifndef TYSTL_INSTRUMENT
+#define TYSTL_INSTRUMENT 0
+#endif
+
+namespace tystl::instrument {
+
+inline constexpr bool kEnabled = TYSTL_INSTRUMENT != 0;
+
+enum class Counter : std::size_t {
+  // Strong and weak reference count changes of SharedPtr, WeakPtr and
+  // IntrusivePtr.
+  kRefIncrements,
+  kRefDecrements,
+  // Work done by BinaryHeap and IndexedBinaryHeap. Sifting moves a hole
+  // instead of swapping, so 'kHeapMoves' counts element moves; levels per
+  // sift is the sift depth.
+  kHeapComparisons,
+  kHeapMoves,
+  kHeapSifts,
+  kHeapSiftLevels,
+  kCount,
+};
+
+inline constexpr std::size_t kCounterCount = static_cast<std::size_t>(Counter::kCount);
+
+inline constexpr std::string_view CounterName(Counter counter) noexcept {
+  constexpr std::string_view names[kCounterCount] = {
+    "ref_increments", "ref_decrements", "heap_comparisons", "heap_moves", "heap_sifts", "heap_sift_levels",
+  };
+  return names[static_cast<std::size_t>(counter)];
+}
+
+// Allocations made for objects of one type by MakeShared, AllocateShared,
+// MakeUnique, Any and the control blocks of adopted pointers.
+struct TypeStats {
+  std::string_view name;
+  std::uint64_t allocations = 0;
+  std::uint64_t bytes = 0;
+};
+
+struct Snapshot {
+  std::array<std::uint64_t, kCounterCount> counters{};
+  // In the order the types were first seen.
+  std::vector<TypeStats> types;
+
+  [[nodiscard]]
+  std::uint64_t Get(Counter counter) const noexcept {
+    return counters[static_cast<std::size_t>(counter)];
+  }
+};
+
+// Receives snapshots passed on by 'Export', e.g. to forward them to a
+// metrics system.
+using ExportHook = std::function<void(const Snapshot&)>;
+
+#if TYSTL_INSTRUMENT
+namespace instrument_detail {
+
+// Types past the first 'kMaxTypes - 1' share the last entry.
+inline constexpr std::size_t kMaxTypes = 256;
+
+// The type name as the compiler spells it in a function signature.
+template <typename T>
+constexpr std::string_view TypeName() noexcept {
+  std::string_view name = __PRETTY_FUNCTION__;
+  auto first = name.find("T = ") + 4;
+  auto last = name.find_first_of(";]", first);
+  return name.substr(first, last - first);
+}
+
+// Only the owning thread writes a block, so counting is a plain load and
+// store; the atomics let 'TakeSnapshot' read them from another thread.
+struct Counts {
+  std::atomic<std::uint64_t> counters[kCounterCount] = {};
+  std::atomic<std::uint64_t> allocations[kMaxTypes] = {};
+  std::atomic<std::uint64_t> bytes[kMaxTypes] = {};
+
+  static void Bump(std::atomic<std::uint64_t> &value, std::uint64_t count) noexcept {
+    value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+  }
+
+  void AddTo(Counts &totals) const noexcept {
+    for (std::size_t i = 0; i < kCounterCount; i ++) {
+      Bump(totals.counters[i], counters[i].load(std::memory_order_relaxed));
+    }
+    for (std::size_t i = 0; i < kMaxTypes; i ++) {
+      Bump(totals.allocations[i], allocations[i].load(std::memory_order_relaxed));
+      Bump(totals.bytes[i], bytes[i].load(std::memory_order_relaxed));
+    }
+  }
+};
+
+// The blocks of running threads, the totals of finished ones and the type
+// names. Never destroyed, as thread_local blocks may outlive statics.
+class Registry {
+public:
+  static Registry& Instance() {
+    static auto *registry = new Registry();
+    return *registry;
+  }
+
+  void Attach(Counts *counts) {
+    std::lock_guard lock(mutex_);
+    live_.push_back(counts);
+  }
+
+  void Detach(Counts *counts) {
+    std::lock_guard lock(mutex_);
+    counts->AddTo(finished_);
+    std::erase(live_, counts);
+  }
+
+  // Counts made by a thread whose block is already gone.
+  void AddFinished(Counter counter, std::uint64_t count) {
+    std::lock_guard lock(mutex_);
+    Counts::Bump(finished_.counters[static_cast<std::size_t>(counter)], count);
+  }
+
+  std::size_t AddType(std::string_view name) {
+    std::lock_guard lock(mutex_);
+    if (type_count_ == kMaxTypes - 1) {
+      names_[type_count_] = "(other)";
+      return type_count_;
+    }
+    names_[type_count_] = name;
+    return type_count_ ++;
+  }
+
+  Snapshot Take() {
+    std::lock_guard lock(mutex_);
+    Counts totals;
+    this->Total(totals);
+    Snapshot snapshot;
+    for (std::size_t i = 0; i < kCounterCount; i ++) {
+      snapshot.counters[i] = totals.counters[i].load(std::memory_order_relaxed) -
+                             baseline_.counters[i].load(std::memory_order_relaxed);
+    }
+    auto types = names_[kMaxTypes - 1].empty() ? type_count_ : kMaxTypes;
+    for (std::size_t i = 0; i < types; i ++) {
+      snapshot.types.push_back({names_[i],
+                                totals.allocations[i].load(std::memory_order_relaxed) -
+                                  baseline_.allocations[i].load(std::memory_order_relaxed),
+                                totals.bytes[i].load(std::memory_order_relaxed) -
+                                  baseline_.bytes[i].load(std::memory_order_relaxed)});
+    }
+    return snapshot;
+  }
+
+  // Later snapshots count from here. The blocks themselves are left alone,
+  // since only their threads write them.
+  void Reset() {
+    std::lock_guard lock(mutex_);
+    Counts totals;
+    this->Total(totals);
+    for (std::size_t i = 0; i < kCounterCount; i ++) {
+      baseline_.counters[i].store(totals.counters[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < kMaxTypes; i ++) {
+      baseline_.allocations[i].store(totals.allocations[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      baseline_.bytes[i].store(totals.bytes[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+
+  void SetHook(ExportHook hook) {
+    std::lock_guard lock(mutex_);
+    hook_ = std::move(hook);
+  }
+
+  ExportHook GetHook() {
+    std::lock_guard lock(mutex_);
+    return hook_;
+  }
+
+private:
+  Registry() = default;
+
+  void Total(Counts &totals) const {
+    finished_.AddTo(totals);
+    for (const auto *counts : live_) {
+      counts->AddTo(totals);
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<Counts*> live_;
+  Counts finished_;
+  Counts baseline_;
+  std::string_view names_[kMaxTypes];
+  std::size_t type_count_ = 0;
+  ExportHook hook_;
+};
+
+class ThreadCounts {
+public:
+  // Null once the calling thread's block has been destroyed, as it may be
+  // before other thread_local objects that still release references.
+  static Counts* Instance() {
+    if (torn_down_) [[unlikely]] {
+      return nullptr;
+    }
+    thread_local ThreadCounts counts;
+    return &counts.counts_;
+  }
+
+  ThreadCounts() {
+    Registry::Instance().Attach(&counts_);
+  }
+
+  ~ThreadCounts() {
+    torn_down_ = true;
+    Registry::Instance().Detach(&counts_);
+  }
+
+private:
+  static inline thread_local bool torn_down_ = false;
+
+  Counts counts_;
+};
+
+template <typename T>
+std::size_t TypeIndex() {
+  static const auto index = Registry::Instance().AddType(TypeName<T>());
+  return index;
+}
+
+inline void Add(Counter counter, std::uint64_t count) noexcept {
+  if (auto *counts = ThreadCounts::Instance()) [[likely]] {
+    Counts::Bump(counts->counters[static_cast<std::size_t>(counter)], count);
+  } else {
+    Registry::Instance().AddFinished(counter, count);
+  }
+}
+
+template <typename T>
+void AddAllocation(std::size_t bytes) noexcept {
+  // An allocation after the thread's block is gone is not counted.
+  if (auto *counts = ThreadCounts::Instance()) [[likely]] {
+    auto index = TypeIndex<T>();
+    Counts::Bump(counts->allocations[index], 1);
+    Counts::Bump(counts->bytes[index], bytes);
+  }
+}
+
+} // namespace instrument_detail
+#endif
+
+// Adds 'count' to 'counter' for the calling thread.
+constexpr void Count([[maybe_unused]] Counter counter, [[maybe_unused]] std::uint64_t count = 1) noexcept {
+#if TYSTL_INSTRUMENT
+  if !consteval {
+    instrument_detail::Add(counter, count);
+  }
+#endif
+}
+
+// Records a heap sift that moved its hole 'levels' levels: one element
+// move per level and one to place the sifted element.
+constexpr void CountSift(std::uint64_t levels) noexcept {
+  Count(Counter::kHeapSifts);
+  Count(Counter::kHeapSiftLevels, levels);
+  Count(Counter::kHeapMoves, levels + 1);
+}
+
+// Records one allocation of 'bytes' made for a 'T'.
+template <typename T>
+constexpr void CountAllocation([[maybe_unused]] std::size_t bytes) noexcept {
+#if TYSTL_INSTRUMENT
+  if !consteval {
+    instrument_detail::AddAllocation<T>(bytes);
+  }
+#endif
+}
+
+// The counts of all threads since the start or the last 'Reset'.
+inline Snapshot TakeSnapshot() {
+#if TYSTL_INSTRUMENT
+  return instrument_detail::Registry::Instance().Take();
+#else
+  return {};
+#endif
+}
+
+inline void Reset() {
+#if TYSTL_INSTRUMENT
+  instrument_detail::Registry::Instance().Reset();
+#endif
+}
+
+inline void SetExportHook([[maybe_unused]] ExportHook hook) {
+#if TYSTL_INSTRUMENT
+  instrument_detail::Registry::Instance().SetHook(std::move(hook));
+#endif
+}
+
+// Passes a snapshot to the export hook, if one is set, and returns it.
+inline Snapshot Export() {
+  auto snapshot = TakeSnapshot();
+#if TYSTL_INSTRUMENT
+  if (auto hook = instrument_detail::Registry::Instance().GetHook()) {
+    hook(snapshot);
+  }
+#endif
+  return snapshot;
+}
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "SharedPtr.hpp"
+#include "Utility.hpp"
+#include <compare>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace tystl {
+
+// CRTP base that embeds the reference count in the object itself. The
+// count is not copied with the object, and the object deletes itself as
+// 'T' once the last IntrusivePtr is gone, so a type reached through a base
+// pointer needs a virtual destructor.
+template <typename T, typename Policy = AtomicRefPolicy>
+class RefCounted {
+public:
+  constexpr void AddRef() const noexcept {
+    Policy::Increment(ref_count_);
+  }
+
+  constexpr void SubRef() const noexcept {
+    if (Policy::Decrement(ref_count_)) {
+      delete static_cast<const T*>(this);
+    }
+  }
+
+  constexpr std::size_t UseCount() const noexcept {
+    return Policy::Load(ref_count_);
+  }
+
+protected:
+  constexpr RefCounted() noexcept = default;
+
+  constexpr RefCounted(const RefCounted &) noexcept {}
+
+  constexpr RefCounted& operator=(const RefCounted &) noexcept {
+    return *this;
+  }
+
+  constexpr ~RefCounted() = default;
+
+private:
+  mutable typename Policy::CountType ref_count_{0};
+};
+
+template <typename T>
+using LocalRefCounted = RefCounted<T, LocalRefPolicy>;
+
+template <typename T>
+concept IntrusiveRefCountable = requires (const T &value) {
+  value.AddRef();
+  value.SubRef();
+};
+
+// A single pointer handle to an object that counts its own references, see
+// 'RefCounted'. Since the count lives in the object, a new handle can be
+// made from any raw pointer to it, including 'this'.
+template <typename T>
+class IntrusivePtr {
+public:
+  using ElementType = T;
+  using Pointer     = T*;
+
+public:
+  constexpr IntrusivePtr() noexcept = default;
+
+  constexpr IntrusivePtr(std::nullptr_t) noexcept {}
+
+  // With 'add_ref' false the handle adopts a reference the caller already owns.
+  constexpr explicit IntrusivePtr(T *ptr, bool add_ref = true) noexcept : ptr_(ptr) {
+    if (ptr_ != nullptr && add_ref) {
+      ptr_->AddRef();
+    }
+  }
+
+  constexpr IntrusivePtr(const IntrusivePtr &other) noexcept : IntrusivePtr(other.ptr_) {}
+
+  constexpr IntrusivePtr(IntrusivePtr &&other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+  template <typename T2>
+    requires std::is_convertible_v<T2*, T*>
+  constexpr IntrusivePtr(const IntrusivePtr<T2> &other) noexcept : IntrusivePtr(other.Get()) {}
+
+  template <typename T2>
+    requires std::is_convertible_v<T2*, T*>
+  constexpr IntrusivePtr(IntrusivePtr<T2> &&other) noexcept : ptr_(other.Release()) {}
+
+  constexpr IntrusivePtr& operator=(IntrusivePtr other) noexcept {
+    this->Swap(other);
+    return *this;
+  }
+
+  constexpr ~IntrusivePtr() {
+    if (ptr_ != nullptr) {
+      ptr_->SubRef();
+    }
+  }
+
+  constexpr void Swap(IntrusivePtr &other) noexcept {
+    tystl::Swap(ptr_, other.ptr_);
+  }
+
+  constexpr void Reset(T *ptr = nullptr) noexcept {
+    IntrusivePtr(ptr).Swap(*this);
+  }
+
+  // Gives up the handle without dropping its reference.
+  [[nodiscard]]
+  constexpr Pointer Release() noexcept {
+    return std::exchange(ptr_, nullptr);
+  }
+
+  [[nodiscard]]
+  constexpr Pointer Get() const noexcept {
+    return ptr_;
+  }
+
+  [[nodiscard]]
+  constexpr T& operator*() const noexcept {
+    return *ptr_;
+  }
+
+  [[nodiscard]]
+  constexpr Pointer operator->() const noexcept {
+    return ptr_;
+  }
+
+  constexpr explicit operator bool() const noexcept {
+    return ptr_ != nullptr;
+  }
+
+  template <typename T2>
+  constexpr bool operator==(const IntrusivePtr<T2> &other) const noexcept {
+    return ptr_ == other.Get();
+  }
+
+  constexpr bool operator==(std::nullptr_t) const noexcept {
+    return ptr_ == nullptr;
+  }
+
+  template <typename T2>
+  constexpr auto operator<=>(const IntrusivePtr<T2> &other) const noexcept {
+    return std::compare_three_way()(ptr_, other.Get());
+  }
+
+private:
+  T* ptr_ = nullptr;
+};
+
+static_assert(sizeof(IntrusivePtr<int>) == sizeof(int*));
+
+template <typename T>
+struct IsTriviallyRelocatable<IntrusivePtr<T>> : std::true_type {};
+
+template <typename T, typename ...Args>
+  requires std::is_constructible_v<T, Args...> && IntrusiveRefCountable<T>
+[[nodiscard]]
+constexpr IntrusivePtr<T> MakeIntrusive(Args &&...args) {
+  return IntrusivePtr<T>(new T(tystl::Forward<Args>(args)...));
+}
+
+// Casts to a type the caller knows the object to be, for example down to the
+// most derived type before converting to one of its other bases.
+template <typename To, typename From>
+[[nodiscard]]
+constexpr IntrusivePtr<To> StaticPointerCast(IntrusivePtr<From> ptr) noexcept {
+  return IntrusivePtr<To>(static_cast<To*>(ptr.Release()), false);
+}
+
+template <typename To, typename From>
+[[nodiscard]]
+constexpr IntrusivePtr<To> ConstPointerCast(IntrusivePtr<From> ptr) noexcept {
+  return IntrusivePtr<To>(const_cast<To*>(ptr.Release()), false);
+}
+
+template <typename To, typename From>
+[[nodiscard]]
+IntrusivePtr<To> DynamicPointerCast(const IntrusivePtr<From> &ptr) noexcept {
+  return IntrusivePtr<To>(dynamic_cast<To*>(ptr.Get()));
+}
+
+}
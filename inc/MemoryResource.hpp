@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Arena.hpp"
+#include "Pool.hpp"
+#include <concepts>
+#include <cstddef>
+#include <memory_resource>
+
+namespace tystl {
+
+template <typename Source>
+concept MemorySource = requires(Source &source, void *ptr, std::size_t bytes, std::size_t align) {
+  { source.Allocate(bytes, align) } -> std::same_as<void*>;
+  source.Deallocate(ptr, bytes, align);
+};
+
+// Exposes an Arena, Pool or any other 'MemorySource' as a
+// std::pmr::memory_resource, so std::pmr containers can use it. The source
+// must outlive the adapter.
+template <MemorySource Source>
+class MemoryResourceAdapter final : public std::pmr::memory_resource {
+public:
+  explicit MemoryResourceAdapter(Source &source) noexcept : source_(&source) {}
+
+  [[nodiscard]]
+  Source& GetSource() const noexcept {
+    return *source_;
+  }
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    return source_->Allocate(bytes, align);
+  }
+
+  void do_deallocate(void *ptr, std::size_t bytes, std::size_t align) override {
+    source_->Deallocate(ptr, bytes, align);
+  }
+
+  // Identity, as telling another adapter apart would need RTTI.
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  Source *source_;
+};
+
+// The process wide Pool as a memory resource.
+inline std::pmr::memory_resource* PoolResource() noexcept {
+  static Pool pool;
+  static MemoryResourceAdapter<Pool> resource(pool);
+  return &resource;
+}
+
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Backoff.hpp"
+#include "SpscQueue.hpp"
+#include "Utility.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace tystl {
+
+// A bounded queue for any number of producer and consumer threads, after
+// Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence number
+// that says whose turn it is: a producer may fill the cell for position
+// 'pos' when its sequence is 'pos', a consumer may empty it when it is
+// 'pos + 1'. Claiming a position is one CAS on the shared enqueue or
+// dequeue index, which sit on cache lines of their own; the cells are not
+// padded, so neighbouring positions may share a line.
+//
+// A full queue makes pushes fail and an empty one makes pops fail; neither
+// blocks the other side. Elements must be nothrow movable, since a claimed
+// cell has to be filled or emptied no matter what.
+template <typename T>
+  requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+class MpmcQueue {
+public:
+  // Rounds 'capacity' up to a power of two, at least 2.
+  explicit MpmcQueue(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1),
+        cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue &) = delete;
+
+  MpmcQueue& operator=(const MpmcQueue &) = delete;
+
+  ~MpmcQueue() {
+    auto tail = enqueue_pos_.load(std::memory_order_relaxed);
+    for (auto head = dequeue_pos_.load(std::memory_order_relaxed); head != tail; head++) {
+      std::destroy_at(cells_[head & mask_].slot.Get());
+    }
+  }
+
+public:
+  auto Capacity() const noexcept -> std::size_t { return mask_ + 1; }
+
+  // Approximate while other threads push or pop.
+  auto Size() const noexcept -> std::size_t {
+    auto head = dequeue_pos_.load(std::memory_order_relaxed);
+    auto tail = enqueue_pos_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+  auto Empty() const noexcept -> bool { return this->Size() == 0; }
+
+  // Returns false, leaving 'value' alone, if the queue is full.
+  auto TryPush(const T &value) -> bool {
+    if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+      return this->TryEmplace(value);
+    } else {
+      return this->TryPush(T(value));
+    }
+  }
+
+  auto TryPush(T &&value) -> bool {
+    return this->TryEmplace(tystl::Move(value));
+  }
+
+  // Builds the element in its cell if that cannot throw, otherwise builds it
+  // first and moves it in. The arguments are not touched if the queue is
+  // full and the element is built in place.
+  template <typename... Ts>
+    requires std::is_constructible_v<T, Ts...>
+  auto TryEmplace(Ts &&...args) -> bool {
+    if constexpr (!std::is_nothrow_constructible_v<T, Ts...>) {
+      return this->TryEmplace(T(tystl::Forward<Ts>(args)...));
+    } else {
+      auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+      while (true) {
+        auto &cell = cells_[pos & mask_];
+        auto diff = Distance(cell.sequence.load(std::memory_order_acquire), pos);
+        if (diff == 0) {
+          if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            std::construct_at(cell.slot.Get(), tystl::Forward<Ts>(args)...);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          // The cell still holds the element from one lap ago.
+          return false;
+        } else {
+          pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+  // Waits while the queue is full.
+  auto Push(T value) -> void {
+    Backoff backoff;
+    while (!this->TryPush(tystl::Move(value))) {
+      backoff.Pause();
+    }
+  }
+
+  // Builds the element in its cell once there is room, when that cannot
+  // throw; otherwise it is built once up front and moved in.
+  template <typename... Ts>
+    requires std::is_constructible_v<T, Ts...>
+  auto Emplace(Ts &&...args) -> void {
+    if constexpr (std::is_nothrow_constructible_v<T, Ts...>) {
+      Backoff backoff;
+      while (!this->TryEmplace(tystl::Forward<Ts>(args)...)) {
+        backoff.Pause();
+      }
+    } else {
+      this->Push(T(tystl::Forward<Ts>(args)...));
+    }
+  }
+
+  // Claims up to 'count' consecutive free cells with one CAS, fills them
+  // from 'first' and returns how many there were. Pass a move iterator to
+  // move the elements in.
+  template <std::input_iterator It>
+    requires std::is_nothrow_constructible_v<T, std::iter_reference_t<It>>
+  auto PushN(It first, std::size_t count) -> std::size_t {
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    auto claimed = this->Claim(enqueue_pos_, pos, count, 0);
+    for (std::size_t i = 0; i < claimed; i++, ++first) {
+      auto &cell = cells_[(pos + i) & mask_];
+      std::construct_at(cell.slot.Get(), *first);
+      cell.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    return claimed;
+  }
+
+  // Moves the oldest element into 'out', or returns false if the queue is
+  // empty.
+  auto TryPop(T &out) -> bool {
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      auto &cell = cells_[pos & mask_];
+      auto diff = Distance(cell.sequence.load(std::memory_order_acquire), pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          this->Take(cell, pos, out);
+          return true;
+        }
+      } else if (diff < 0) {
+        // Not filled yet.
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Waits while the queue is empty.
+  auto Pop(T &out) -> void {
+    Backoff backoff;
+    while (!this->TryPop(out)) {
+      backoff.Pause();
+    }
+  }
+
+  // Claims up to 'count' consecutive filled cells with one CAS, moves them
+  // to 'out' and returns how many there were. Assigning through 'out' must
+  // not throw, for the same reason elements must be nothrow movable, so a
+  // growing sink such as std::back_inserter does not qualify.
+  template <std::output_iterator<T&&> OutIt>
+    requires std::is_nothrow_assignable_v<std::iter_reference_t<OutIt>, T&&>
+  auto PopN(OutIt out, std::size_t count) -> std::size_t {
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    auto claimed = this->Claim(dequeue_pos_, pos, count, 1);
+    for (std::size_t i = 0; i < claimed; i++) {
+      this->Take(cells_[(pos + i) & mask_], pos + i, *out);
+      ++out;
+    }
+    return claimed;
+  }
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    RingSlot<T> slot;
+  };
+
+  static auto Distance(std::size_t sequence, std::size_t expected) noexcept -> std::intptr_t {
+    return static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(expected);
+  }
+
+  // Counts the cells from 'pos' on whose sequence is 'pos + i + lag', up to
+  // 'count', and moves 'index' past them. Only cells that were ready before
+  // the CAS are claimed, so the caller owns all of them. Returns 0 with
+  // 'pos' reloaded if the first cell is not ready.
+  auto Claim(std::atomic<std::size_t> &index, std::size_t &pos, std::size_t count, std::size_t lag) -> std::size_t {
+    while (true) {
+      std::size_t ready = 0;
+      while (ready < count && ready <= mask_ &&
+             cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire) == pos + ready + lag) {
+        ready++;
+      }
+      if (ready == 0) {
+        auto current = index.load(std::memory_order_relaxed);
+        if (current == pos) {
+          return 0;
+        }
+        pos = current;
+        continue;
+      }
+      if (index.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+        return ready;
+      }
+    }
+  }
+
+  // Moves the element at 'pos' out and hands the cell to the producer one
+  // lap ahead.
+  template <typename Out>
+  auto Take(Cell &cell, std::size_t pos, Out &&out) noexcept -> void {
+    auto *value = cell.slot.Get();
+    out = tystl::Move(*value);
+    std::destroy_at(value);
+    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+  }
+
+private:
+  std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLineSize) std::atomic<std::size_t> enqueue_pos_{0};
+  alignas(kCacheLineSize) std::atomic<std::size_t> dequeue_pos_{0};
+};
+
+}
@@ -1,7 +1,11 @@
 #pragma once
 
-#include <array>
+#include "Utility.hpp"
+#include <concepts>
 #include <cstdint>
+#include <exception>
+#include <memory>
+#include <type_traits>
 
 namespace tystl {
 
@@ -9,150 +13,358 @@ struct Nullopt {
   Nullopt() = default;
 } inline none;
 
+// Specialize for a trivially copyable type that has a bit pattern no real
+// value uses, so Optional<T> can store "empty" as that pattern instead of
+// keeping a separate flag:
+//
+//   static T Empty() noexcept;               // the unused pattern
+//   static bool IsEmpty(const T &) noexcept; // recognises it
+//
+// An enum with a spare enumerator can opt in with 'OptionalNicheValue'.
+template <typename Ty>
+struct OptionalNiche {};
+
+// No pointer to an object is all ones.
+template <typename Ty>
+struct OptionalNiche<Ty *> {
+  static auto Empty() noexcept -> Ty * {
+    return reinterpret_cast<Ty *>(~std::uintptr_t{0});
+  }
+
+  static auto IsEmpty(Ty *value) noexcept -> bool {
+    return reinterpret_cast<std::uintptr_t>(value) == ~std::uintptr_t{0};
+  }
+};
+
+// Uses one value of a type as its empty state, e.g.
+//   template <> struct tystl::OptionalNiche<Color> : tystl::OptionalNicheValue<Color(0xff)> {};
+template <auto Value>
+struct OptionalNicheValue {
+  static constexpr auto Empty() noexcept -> decltype(Value) { return Value; }
+
+  static constexpr auto IsEmpty(decltype(Value) value) noexcept -> bool {
+    return value == Value;
+  }
+};
+
+template <typename Ty>
+concept HasOptionalNiche = std::is_trivially_copyable_v<Ty> && requires(const Ty &value) {
+  { OptionalNiche<Ty>::Empty() } -> std::same_as<Ty>;
+  { OptionalNiche<Ty>::IsEmpty(value) } -> std::same_as<bool>;
+};
+
+// A value plus a flag.
+template <typename Ty, bool = HasOptionalNiche<Ty>>
+struct OptionalStorage {
+  constexpr OptionalStorage() noexcept : empty_(), has_value_{false} {}
+
+  constexpr OptionalStorage(const OptionalStorage &) = default;
+
+  constexpr OptionalStorage(OptionalStorage &&) = default;
+
+  constexpr auto operator=(const OptionalStorage &) -> OptionalStorage & = default;
+
+  constexpr auto operator=(OptionalStorage &&) -> OptionalStorage & = default;
+
+  constexpr ~OptionalStorage()
+    requires std::is_trivially_destructible_v<Ty>
+  = default;
+
+  // The owning Optional destroys the value.
+  constexpr ~OptionalStorage() {}
+
+  constexpr auto HasValue() const noexcept -> bool { return this->has_value_; }
+
+  template <typename... Args>
+  constexpr auto Construct(Args &&...args) -> void {
+    std::construct_at(std::addressof(this->value_), tystl::Forward<Args>(args)...);
+    this->has_value_ = true;
+  }
+
+  constexpr auto Destroy() noexcept -> void {
+    std::destroy_at(std::addressof(this->value_));
+    this->has_value_ = false;
+  }
+
+  union {
+    char empty_;
+    Ty value_;
+  };
+  bool has_value_;
+};
+
+// The value alone, empty while it holds the niche pattern.
+template <typename Ty>
+struct OptionalStorage<Ty, true> {
+  constexpr OptionalStorage() noexcept : value_(OptionalNiche<Ty>::Empty()) {}
+
+  constexpr auto HasValue() const noexcept -> bool {
+    return !OptionalNiche<Ty>::IsEmpty(this->value_);
+  }
+
+  template <typename... Args>
+  constexpr auto Construct(Args &&...args) -> void {
+    this->value_ = Ty(tystl::Forward<Args>(args)...);
+  }
+
+  constexpr auto Destroy() noexcept -> void {
+    this->value_ = OptionalNiche<Ty>::Empty();
+  }
+
+  Ty value_;
+};
+
+// Holds a 'Ty' or nothing. Types with an 'OptionalNiche' take no extra
+// space, and every special member is trivial when the matching one of
+// 'Ty' is, so Optional<int> can be copied with memcpy.
 template <typename Ty>
 class Optional {
 private:
-  using TDataByte = std::array<std::uint8_t, sizeof(Ty)>;
   using TValue = Ty;
 
 public:
-  constexpr Optional() noexcept : has_value_{false} {}
+  constexpr Optional() noexcept = default;
 
   constexpr Optional(Nullopt) noexcept : Optional() {}
 
-  constexpr Optional(const Ty &init) : has_value_{true} {
-    this->ConstructData(init);
+  constexpr Optional(const Ty &init) {
+    this->storage_.Construct(init);
   }
 
-  constexpr Optional(Ty &&init) : has_value_{true} {
-    this->ConstructData(std::move(init));
+  constexpr Optional(Ty &&init) {
+    this->storage_.Construct(tystl::Move(init));
   }
 
-  constexpr Optional(const Optional &other) : has_value_{other.has_value_} {
-    if (other.has_value_)
-      this->ConstructData(*other);
+  constexpr Optional(const Optional &other)
+    requires std::is_trivially_copy_constructible_v<Ty>
+  = default;
+
+  constexpr Optional(const Optional &other)
+    requires(!std::is_trivially_copy_constructible_v<Ty> && std::is_copy_constructible_v<Ty>) {
+    if (other.HasValue()) {
+      this->storage_.Construct(*other);
+    }
   }
 
-  constexpr Optional(Optional &&other) noexcept
-      : data_(std::move(other.data_)), has_value_{std::move(other.has_value_)} {
-    other.has_value_ = false;
+  constexpr Optional(Optional &&other)
+    requires std::is_trivially_move_constructible_v<Ty>
+  = default;
+
+  constexpr Optional(Optional &&other) noexcept(std::is_nothrow_move_constructible_v<Ty>)
+    requires(!std::is_trivially_move_constructible_v<Ty> && std::is_move_constructible_v<Ty>) {
+    if (other.HasValue()) {
+      this->storage_.Construct(tystl::Move(*other));
+    }
   }
 
-  constexpr auto operator=(const Optional &other) -> Optional & {
-    this->Reset();
-    if (other.has_value_)
-      this->ConstructData(*other);
-    this->has_value_ = other.has_value_;
+  constexpr auto operator=(const Optional &other) -> Optional &
+    requires(std::is_trivially_copy_assignable_v<Ty> &&
+             std::is_trivially_copy_constructible_v<Ty> &&
+             std::is_trivially_destructible_v<Ty>)
+  = default;
+
+  constexpr auto operator=(const Optional &other) -> Optional &
+    requires(!(std::is_trivially_copy_assignable_v<Ty> &&
+               std::is_trivially_copy_constructible_v<Ty> &&
+               std::is_trivially_destructible_v<Ty>) &&
+             std::is_copy_constructible_v<Ty> && std::is_copy_assignable_v<Ty>) {
+    if (this == &other) {
+      return *this;
+    }
+    if (!other.HasValue()) {
+      this->Reset();
+    } else if (this->HasValue()) {
+      **this = *other;
+    } else {
+      this->storage_.Construct(*other);
+    }
+    return *this;
+  }
+
+  constexpr auto operator=(Optional &&other) -> Optional &
+    requires(std::is_trivially_move_assignable_v<Ty> &&
+             std::is_trivially_move_constructible_v<Ty> &&
+             std::is_trivially_destructible_v<Ty>)
+  = default;
+
+  constexpr auto operator=(Optional &&other) noexcept(std::is_nothrow_move_constructible_v<Ty> &&
+                                                      std::is_nothrow_move_assignable_v<Ty>) -> Optional &
+    requires(!(std::is_trivially_move_assignable_v<Ty> &&
+               std::is_trivially_move_constructible_v<Ty> &&
+               std::is_trivially_destructible_v<Ty>) &&
+             std::is_move_constructible_v<Ty> && std::is_move_assignable_v<Ty>) {
+    if (this == &other) {
+      return *this;
+    }
+    if (!other.HasValue()) {
+      this->Reset();
+    } else if (this->HasValue()) {
+      **this = tystl::Move(*other);
+    } else {
+      this->storage_.Construct(tystl::Move(*other));
+    }
+    return *this;
   }
 
-  constexpr auto operator=(Optional &&other) noexcept {
+  constexpr auto operator=(Nullopt) noexcept -> Optional & {
     this->Reset();
-    this->data_ = std::move(other.data_);
-    this->has_value_ = other.has_value_;
-    other.has_value_ = false;
+    return *this;
   }
 
+  constexpr ~Optional()
+    requires std::is_trivially_destructible_v<Ty>
+  = default;
+
   constexpr ~Optional() noexcept {
-    this->ReinterpretCastData()->~Ty();
-    this->has_value_ = false;
+    this->Reset();
   }
 
 public:
-  constexpr auto HasValue() const noexcept -> bool { return this->has_value_; }
+  constexpr auto HasValue() const noexcept -> bool { return this->storage_.HasValue(); }
 
   constexpr explicit operator bool() const noexcept { return this->HasValue(); }
 
 public:
   constexpr auto operator->() const noexcept -> const Ty * {
-    return this->ReinterpretCastData();
+    return std::addressof(this->storage_.value_);
   }
 
   constexpr auto operator->() noexcept -> Ty * {
-    return this->ReinterpretCastData();
+    return std::addressof(this->storage_.value_);
   }
 
   constexpr auto operator*() const & noexcept -> const Ty & {
-    return *this->ReinterpretCastData();
+    return this->storage_.value_;
   }
 
   constexpr auto operator*() & noexcept -> Ty & {
-    return *this->ReinterpretCastData();
+    return this->storage_.value_;
   }
 
   constexpr auto operator*() const && noexcept -> const Ty && {
-    return std::move(*this->ReinterpretCastData());
+    return tystl::Move(this->storage_.value_);
   }
 
   constexpr auto operator*() && noexcept -> Ty && {
-    return std::move(*this->ReinterpretCastData());
+    return tystl::Move(this->storage_.value_);
   }
 
 public:
-  template <typename... Args> constexpr auto Emplace(Args &&...args) -> void {
-    if (this->has_value_) {
-      this->Reset();
-    }
-    this->ConstructData(std::forward<Args>(args)...);
+  template <typename... Args>
+    requires std::is_constructible_v<Ty, Args...>
+  constexpr auto Emplace(Args &&...args) -> void {
+    this->Reset();
+    this->storage_.Construct(tystl::Forward<Args>(args)...);
   }
 
   constexpr auto Reset() noexcept -> void {
-    if (this->has_value_) {
-      this->ReinterpretCastData()->~Ty();
+    if (this->HasValue()) {
+      this->storage_.Destroy();
     }
   }
 
-  constexpr auto Swap(Optional &other) noexcept -> void {
-    std::swap(this->data_, other.data_);
-    std::swap(this->has_value_, other.has_value_);
+  constexpr auto Swap(Optional &other) noexcept(std::is_nothrow_move_constructible_v<Ty> &&
+                                                std::is_nothrow_swappable_v<Ty>) -> void {
+    if (this->HasValue() && other.HasValue()) {
+      tystl::Swap(**this, *other);
+    } else if (this->HasValue()) {
+      other.storage_.Construct(tystl::Move(**this));
+      this->Reset();
+    } else if (other.HasValue()) {
+      this->storage_.Construct(tystl::Move(*other));
+      other.Reset();
+    }
   }
 
   constexpr auto Value() const & -> const Ty & {
-    if (this->has_value_) {
+    if (this->HasValue()) {
       return **this;
     }
     throw std::exception();
   }
 
   constexpr auto Value() const && -> const Ty && {
-    if (this->has_value_) {
-      return std::move(**this);
+    if (this->HasValue()) {
+      return tystl::Move(**this);
     }
     throw std::exception();
   }
 
   template <typename U>
   constexpr auto ValueOr(U &&default_value) const & -> Ty {
-    if (this->has_value_) {
+    if (this->HasValue()) {
       return **this;
     }
-    return static_cast<Ty>(default_value);
+    return static_cast<Ty>(tystl::Forward<U>(default_value));
   }
 
-  template <typename U> constexpr auto ValueOr(U &&default_value) && -> Ty {
-    if (this->has_value_) {
-      return std::move(**this);
+  template <typename U>
+  constexpr auto ValueOr(U &&default_value) && -> Ty {
+    if (this->HasValue()) {
+      return tystl::Move(**this);
     }
-    return static_cast<Ty>(default_value);
+    return static_cast<Ty>(tystl::Forward<U>(default_value));
   }
 
 private:
-  template <typename... Args>
-    requires requires(Args... args) { new Ty(args...); }
-  constexpr auto ConstructData(Args &&...args) -> void {
-    new (this->data_.data()) Ty(std::forward<Args>(args)...);
+  OptionalStorage<Ty> storage_;
+};
+
+// An optional reference is a pointer, null when empty.
+template <typename Ty>
+class Optional<Ty &> {
+public:
+  constexpr Optional() noexcept = default;
+
+  constexpr Optional(Nullopt) noexcept : Optional() {}
+
+  constexpr Optional(Ty &init) noexcept : ptr_(std::addressof(init)) {}
+
+  Optional(Ty &&) = delete;
+
+  constexpr auto operator=(Nullopt) noexcept -> Optional & {
+    this->Reset();
+    return *this;
   }
 
-  constexpr auto ReinterpretCastData() noexcept -> Ty * {
-    return reinterpret_cast<Ty *>(this->data_.data());
+public:
+  constexpr auto HasValue() const noexcept -> bool { return this->ptr_ != nullptr; }
+
+  constexpr explicit operator bool() const noexcept { return this->HasValue(); }
+
+  constexpr auto operator->() const noexcept -> Ty * { return this->ptr_; }
+
+  constexpr auto operator*() const noexcept -> Ty & { return *this->ptr_; }
+
+public:
+  constexpr auto Emplace(Ty &value) noexcept -> void { this->ptr_ = std::addressof(value); }
+
+  constexpr auto Reset() noexcept -> void { this->ptr_ = nullptr; }
+
+  constexpr auto Swap(Optional &other) noexcept -> void { tystl::Swap(this->ptr_, other.ptr_); }
+
+  constexpr auto Value() const -> Ty & {
+    if (this->HasValue()) {
+      return *this->ptr_;
+    }
+    throw std::exception();
   }
 
-  constexpr auto ReinterpretCastData() const noexcept -> const Ty * {
-    return reinterpret_cast<const Ty *>(this->data_.data());
+  template <typename U>
+  constexpr auto ValueOr(U &&default_value) const -> std::remove_cv_t<Ty> {
+    if (this->HasValue()) {
+      return *this->ptr_;
+    }
+    return static_cast<std::remove_cv_t<Ty>>(tystl::Forward<U>(default_value));
   }
 
 private:
-  TDataByte data_;
-  bool has_value_;
+  Ty *ptr_ = nullptr;
 };
 
+static_assert(sizeof(Optional<int *>) == sizeof(int *));
+static_assert(sizeof(Optional<int &>) == sizeof(int *));
+static_assert(std::is_trivially_copyable_v<Optional<int>>);
+static_assert(std::is_trivially_copyable_v<Optional<double *>>);
+
 } // namespace tystl
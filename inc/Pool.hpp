@@ -0,0 +1,270 @@
+#pragma once
+
+#include "UniquePtr.hpp"
+#include "Utility.hpp"
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tystl {
+
+namespace pool_detail {
+
+// Size classes are the powers of two from 16 to 2048 bytes.
+inline constexpr std::size_t kMinClassSize = 16;
+inline constexpr std::size_t kClassCount = 8;
+inline constexpr std::size_t kMaxClassSize = kMinClassSize << (kClassCount - 1);
+inline constexpr std::size_t kSlabSize = 64 * 1024;
+
+// Blocks moved between a thread and the central lists at a time, and the
+// number a thread keeps before returning some.
+inline constexpr std::size_t kBatchSize = 32;
+inline constexpr std::size_t kMaxCached = 4 * kBatchSize;
+
+constexpr std::size_t ClassOf(std::size_t bytes) noexcept {
+  return bytes <= kMinClassSize ? 0 : static_cast<std::size_t>(std::bit_width(bytes - 1)) - 4;
+}
+
+constexpr std::size_t ClassSize(std::size_t index) noexcept {
+  return kMinClassSize << index;
+}
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+// Per class free lists shared by all threads, refilled from slabs. Slabs
+// are carved into blocks of one class and never returned to the system,
+// since a block may sit in any thread's cache.
+class Central {
+public:
+  static Central& Instance() {
+    static Central central;
+    return central;
+  }
+
+  // Links up to 'kBatchSize' free blocks of class 'index' and returns the
+  // first one and the count.
+  auto TakeBatch(std::size_t index) -> std::pair<FreeBlock*, std::size_t> {
+    std::lock_guard lock(mutex_);
+    if (lists_[index] == nullptr) {
+      this->CarveSlab(index);
+    }
+    auto *first = lists_[index];
+    auto *last = first;
+    std::size_t count = 1;
+    while (count < kBatchSize && last->next != nullptr) {
+      last = last->next;
+      count++;
+    }
+    lists_[index] = last->next;
+    last->next = nullptr;
+    return {first, count};
+  }
+
+  void* AllocateOne(std::size_t index) {
+    auto [block, count] = this->TakeBatch(index);
+    if (count > 1) {
+      this->GiveBack(index, block->next, LastOf(block->next));
+    }
+    return block;
+  }
+
+  static FreeBlock* LastOf(FreeBlock *first) noexcept {
+    while (first->next != nullptr) {
+      first = first->next;
+    }
+    return first;
+  }
+
+  // Takes back a list of blocks ending in 'last'.
+  void GiveBack(std::size_t index, FreeBlock *first, FreeBlock *last) noexcept {
+    std::lock_guard lock(mutex_);
+    last->next = lists_[index];
+    lists_[index] = first;
+  }
+
+private:
+  void CarveSlab(std::size_t index) {
+    auto size = ClassSize(index);
+    auto *slab = static_cast<std::byte*>(::operator new(kSlabSize, std::align_val_t{kMaxClassSize}));
+    FreeBlock *head = nullptr;
+    for (auto offset = kSlabSize; offset >= size; offset -= size) {
+      head = ::new (slab + offset - size) FreeBlock{head};
+    }
+    lists_[index] = head;
+  }
+
+private:
+  std::mutex mutex_;
+  FreeBlock *lists_[kClassCount] = {};
+};
+
+// One per thread; allocation and deallocation only touch the calling
+// thread's lists except when a list runs empty or grows past 'kMaxCached'.
+class ThreadCache {
+public:
+  // Null once the calling thread's cache has been destroyed, as it may be
+  // before other thread_local objects that still free memory.
+  static ThreadCache* Instance() {
+    if (torn_down_) [[unlikely]] {
+      return nullptr;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  ~ThreadCache() {
+    torn_down_ = true;
+    for (std::size_t index = 0; index < kClassCount; index++) {
+      if (lists_[index] != nullptr) {
+        Central::Instance().GiveBack(index, lists_[index], Central::LastOf(lists_[index]));
+      }
+    }
+  }
+
+  void* Allocate(std::size_t index) {
+    if (lists_[index] == nullptr) [[unlikely]] {
+      auto [first, count] = Central::Instance().TakeBatch(index);
+      lists_[index] = first;
+      counts_[index] = count;
+    }
+    auto *block = lists_[index];
+    lists_[index] = block->next;
+    counts_[index]--;
+    return block;
+  }
+
+  void Deallocate(std::size_t index, void *ptr) noexcept {
+    lists_[index] = ::new (ptr) FreeBlock{lists_[index]};
+    if (++counts_[index] > kMaxCached) [[unlikely]] {
+      this->Trim(index);
+    }
+  }
+
+private:
+  // Returns a batch to the central list so memory freed by one thread can
+  // be reused by the others.
+  void Trim(std::size_t index) noexcept {
+    auto *first = lists_[index];
+    auto *last = first;
+    for (std::size_t i = 1; i < kBatchSize; i++) {
+      last = last->next;
+    }
+    lists_[index] = last->next;
+    counts_[index] -= kBatchSize;
+    Central::Instance().GiveBack(index, first, last);
+  }
+
+private:
+  static inline thread_local bool torn_down_ = false;
+
+  FreeBlock *lists_[kClassCount] = {};
+  std::size_t counts_[kClassCount] = {};
+};
+
+} // namespace pool_detail
+
+// A thread-caching allocator for small blocks. Requests of up to
+// 'kMaxSize' bytes are rounded up to a power of two size class and served
+// from the calling thread's free list for that class; larger ones go to
+// global 'operator new'. A block may be freed by any thread, it then joins
+// that thread's list.
+//
+// The size given to 'Deallocate' must be the one given to 'Allocate'.
+class Pool {
+public:
+  static constexpr std::size_t kMaxSize = pool_detail::kMaxClassSize;
+
+public:
+  [[nodiscard]]
+  static void* Allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+    // Blocks of a class are aligned to the class size.
+    auto size = bytes < align ? align : bytes;
+    if (size > kMaxSize) {
+      return ::operator new(bytes, std::align_val_t{align});
+    }
+    auto index = pool_detail::ClassOf(size);
+    if (auto *cache = pool_detail::ThreadCache::Instance()) [[likely]] {
+      return cache->Allocate(index);
+    }
+    return pool_detail::Central::Instance().AllocateOne(index);
+  }
+
+  static void Deallocate(void *ptr, std::size_t bytes, std::size_t align = alignof(std::max_align_t)) noexcept {
+    auto size = bytes < align ? align : bytes;
+    if (size > kMaxSize) {
+      ::operator delete(ptr, bytes, std::align_val_t{align});
+      return;
+    }
+    auto index = pool_detail::ClassOf(size);
+    if (auto *cache = pool_detail::ThreadCache::Instance()) [[likely]] {
+      cache->Deallocate(index, ptr);
+      return;
+    }
+    auto *block = ::new (ptr) pool_detail::FreeBlock{nullptr};
+    pool_detail::Central::Instance().GiveBack(index, block, block);
+  }
+};
+
+// A standard allocator over Pool. All of them are equal.
+template <typename T>
+class PoolAllocator {
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+public:
+  constexpr PoolAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+  [[nodiscard]]
+  T* allocate(std::size_t count) {
+    if (count > std::size_t(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(Pool::Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *ptr, std::size_t count) noexcept {
+    Pool::Deallocate(ptr, count * sizeof(T), alignof(T));
+  }
+
+  template <typename U>
+  constexpr bool operator==(const PoolAllocator<U> &) const noexcept {
+    return true;
+  }
+};
+
+// Deleter for objects made by 'MakePoolUnique'. Pool needs the size back,
+// so unlike DefaultDeleter it does not convert between types.
+template <typename T>
+struct PoolDeleter {
+  void operator()(T *ptr) const noexcept {
+    ptr->~T();
+    Pool::Deallocate(ptr, sizeof(T), alignof(T));
+  }
+};
+
+template <typename T>
+using PoolUniquePtr = UniquePtr<T, PoolDeleter<T>>;
+
+template <typename T, typename ...Args>
+  requires std::is_constructible_v<T, Args...>
+[[nodiscard]]
+PoolUniquePtr<T> MakePoolUnique(Args &&...args) {
+  void *ptr = Pool::Allocate(sizeof(T), alignof(T));
+  try {
+    return PoolUniquePtr<T>(::new (ptr) T(tystl::Forward<Args>(args)...));
+  } catch (...) {
+    Pool::Deallocate(ptr, sizeof(T), alignof(T));
+    throw;
+  }
+}
+
+}
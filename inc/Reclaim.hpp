@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Backoff.hpp"
+#include "MpmcQueue.hpp"
+#include "SharedPtr.hpp"
+#include "Utility.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace tystl {
+
+// Moves the destruction of shared objects off latency critical threads.
+// While a thread has a ReclaimScope for the domain, the last SharedPtr it
+// drops to an object queues the control block instead of destroying the
+// object; a background thread, or whoever calls 'Drain', destroys queued
+// objects in batches later. Weak references see the object expire at the
+// release as usual, only the destructor runs later.
+//
+// The queue is bounded. When it is full the releasing thread either runs
+// the destructor itself or waits for the background thread to make room,
+// as 'Options::overflow' says. Objects released on the reclaiming thread,
+// such as the members of a queued object graph, are destroyed right away.
+// Only SharedPtr with AtomicRefPolicy is deferred.
+class ReclaimDomain final : public ReleaseSink {
+public:
+  enum class Overflow {
+    kRunInline,
+    // Needs the background thread, without one it is 'kRunInline'.
+    kWait,
+  };
+
+  struct Options {
+    // Queued releases at most, rounded up to a power of two.
+    std::size_t capacity = 4096;
+
+    Overflow overflow = Overflow::kRunInline;
+
+    // Start a thread that drains the queue as it fills. Without it nothing
+    // is destroyed until 'Drain' is called.
+    bool background = true;
+  };
+
+public:
+  ReclaimDomain() : ReclaimDomain(Options()) {}
+
+  explicit ReclaimDomain(Options options)
+      : overflow_(options.overflow), queue_(options.capacity) {
+    if (options.background) {
+      thread_ = std::thread([this] { this->Reclaim(); });
+    }
+  }
+
+  ReclaimDomain(const ReclaimDomain &) = delete;
+
+  ReclaimDomain& operator=(const ReclaimDomain &) = delete;
+
+  // Destroys whatever is still queued. No thread may still have a scope
+  // for the domain.
+  ~ReclaimDomain() {
+    if (thread_.joinable()) {
+      stop_.store(true, std::memory_order_relaxed);
+      this->Wake();
+      thread_.join();
+    }
+    this->Drain();
+  }
+
+public:
+  // Approximate while other threads release or drain.
+  auto Pending() const noexcept -> std::size_t { return queue_.Size(); }
+
+  auto Capacity() const noexcept -> std::size_t { return queue_.Capacity(); }
+
+  auto HasBackgroundThread() const noexcept -> bool { return thread_.joinable(); }
+
+  // Destroys the objects queued so far on the calling thread and returns
+  // how many there were. Releases it causes run inline, even under a scope.
+  auto Drain() -> std::size_t {
+    auto *sink = std::exchange(shared_ptr_detail::release_sink, nullptr);
+    std::size_t total = 0;
+    while (auto count = this->DestroyBatch()) {
+      total += count;
+    }
+    shared_ptr_detail::release_sink = sink;
+    return total;
+  }
+
+  auto Defer(void *block, Finish finish) noexcept -> bool override {
+    if (!queue_.TryPush(Entry{block, finish})) {
+      if (overflow_ != Overflow::kWait || !thread_.joinable()) {
+        return false;
+      }
+      Backoff backoff;
+      do {
+        this->Wake();
+        backoff.Pause();
+      } while (!queue_.TryPush(Entry{block, finish}));
+    }
+    this->Wake();
+    return true;
+  }
+
+private:
+  struct Entry {
+    void *block;
+    Finish finish;
+  };
+
+  static constexpr std::size_t kBatchSize = 64;
+
+  auto DestroyBatch() noexcept -> std::size_t {
+    Entry batch[kBatchSize];
+    auto count = queue_.PopN(batch, kBatchSize);
+    for (std::size_t i = 0; i < count; i++) {
+      batch[i].finish(batch[i].block);
+    }
+    return count;
+  }
+
+  // The reclaimer either sees the queued entry after its fence or is woken
+  // here, since the fence orders the push before the check.
+  auto Wake() noexcept -> void {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      epoch_.fetch_add(1, std::memory_order_release);
+      epoch_.notify_one();
+    }
+  }
+
+  auto Reclaim() -> void {
+    while (true) {
+      if (this->DestroyBatch() != 0) {
+        continue;
+      }
+      if (stop_.load(std::memory_order_relaxed)) {
+        break;
+      }
+      sleeping_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto epoch = epoch_.load(std::memory_order_acquire);
+      if (queue_.Empty() && !stop_.load(std::memory_order_relaxed)) {
+        epoch_.wait(epoch, std::memory_order_acquire);
+      }
+      sleeping_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  Overflow overflow_;
+  MpmcQueue<Entry> queue_;
+  alignas(kCacheLineSize) std::atomic<bool> sleeping_{false};
+  std::atomic<std::uint32_t> epoch_{0};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+// Sends the final releases made on the calling thread to 'domain' for as
+// long as the scope lives. Scopes nest.
+class ReclaimScope {
+public:
+  explicit ReclaimScope(ReclaimDomain &domain) noexcept
+      : previous_(std::exchange(shared_ptr_detail::release_sink, &domain)) {}
+
+  ReclaimScope(const ReclaimScope &) = delete;
+
+  ReclaimScope& operator=(const ReclaimScope &) = delete;
+
+  ~ReclaimScope() {
+    shared_ptr_detail::release_sink = previous_;
+  }
+
+private:
+  ReleaseSink *previous_;
+};
+
+}
@@ -1,83 +1,393 @@
 #pragma once
 
+#include "Instrument.hpp"
 #include "Utility.hpp"
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
 namespace tystl {
 
-template <typename T>
+// Reference counting policy for objects shared across threads. Taking a new
+// reference never publishes anything, so increments are relaxed; the final
+// decrement acquires so the destructor sees every write made through the
+// other references.
+struct AtomicRefPolicy {
+  using CountType = std::atomic_size_t;
+
+  static void Increment(CountType &count) noexcept {
+    instrument::Count(instrument::Counter::kRefIncrements);
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void Add(CountType &count, std::size_t value) noexcept {
+    instrument::Count(instrument::Counter::kRefIncrements, value);
+    count.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // Returns true when the count dropped to zero.
+  static bool Decrement(CountType &count) noexcept {
+    instrument::Count(instrument::Counter::kRefDecrements);
+    if (count.fetch_sub(1, std::memory_order_release) == 1) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return true;
+    }
+    return false;
+  }
+
+  static bool IncrementIfNonZero(CountType &count) noexcept {
+    auto value = count.load(std::memory_order_relaxed);
+    while (value != 0) {
+      if (count.compare_exchange_weak(value, value + 1,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+        instrument::Count(instrument::Counter::kRefIncrements);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static std::size_t Load(const CountType &count) noexcept {
+    return count.load(std::memory_order_relaxed);
+  }
+};
+
+// Reference counting policy for objects that never leave one thread.
+struct LocalRefPolicy {
+  using CountType = std::size_t;
+
+  static constexpr void Increment(CountType &count) noexcept {
+    instrument::Count(instrument::Counter::kRefIncrements);
+    count ++;
+  }
+
+  static constexpr void Add(CountType &count, std::size_t value) noexcept {
+    instrument::Count(instrument::Counter::kRefIncrements, value);
+    count += value;
+  }
+
+  static constexpr bool Decrement(CountType &count) noexcept {
+    instrument::Count(instrument::Counter::kRefDecrements);
+    return (-- count) == 0;
+  }
+
+  static constexpr bool IncrementIfNonZero(CountType &count) noexcept {
+    if (count == 0) {
+      return false;
+    }
+    instrument::Count(instrument::Counter::kRefIncrements);
+    count ++;
+    return true;
+  }
+
+  static constexpr std::size_t Load(const CountType &count) noexcept {
+    return count;
+  }
+};
+
+template <typename T, typename Policy = AtomicRefPolicy>
 class SharedPtr;
 
-template <typename T>
+template <typename T, typename Policy = AtomicRefPolicy>
 class WeakPtr;
 
-template <typename T>
+template <typename T, typename Policy = AtomicRefPolicy>
 class EnableSharedFromThis;
 
+template <typename T, typename Policy = AtomicRefPolicy>
+class AtomicSharedPtr;
+
+template <typename T, typename Policy = AtomicRefPolicy>
+constexpr bool CanEnableShared = std::is_base_of_v<EnableSharedFromThis<T, Policy>, T>;
+
 template <typename T>
-constexpr bool CanEnableShared = std::is_base_of_v<EnableSharedFromThis<T>, T>;
+using LocalSharedPtr = SharedPtr<T, LocalRefPolicy>;
 
 template <typename T>
-class RefCount {
+using LocalWeakPtr = WeakPtr<T, LocalRefPolicy>;
+
+template <typename T>
+using EnableLocalSharedFromThis = EnableSharedFromThis<T, LocalRefPolicy>;
+
+// Takes over final releases of shared objects from the threads it is
+// installed on, see ReclaimDomain. 'finish(block)' must eventually run for
+// every accepted block.
+class ReleaseSink {
 public:
-  constexpr explicit RefCount(T* ptr) noexcept : ptr_(ptr) {}
-  
+  using Finish = void (*)(void *block) noexcept;
+
+  // Returns false if the release has to run on the calling thread after all.
+  virtual bool Defer(void *block, Finish finish) noexcept = 0;
+
+protected:
+  ~ReleaseSink() = default;
+};
+
+namespace shared_ptr_detail {
+
+// The sink of the calling thread, if any.
+inline thread_local ReleaseSink *release_sink = nullptr;
+
+} // namespace shared_ptr_detail
+
+template <typename Policy>
+class RefCountBase {
+public:
+  constexpr RefCountBase() noexcept = default;
+
+  constexpr RefCountBase(const RefCountBase &) = delete;
+
+  constexpr RefCountBase& operator=(const RefCountBase &) = delete;
+
+  constexpr virtual ~RefCountBase() noexcept = default;
+
   constexpr void AddRef() noexcept {
-    use_ref_ ++;
+    Policy::Increment(use_ref_);
   }
 
+  // Adds 'count' strong references at once, wrapping arithmetic allows a
+  // caller to hand back references as long as the total never reaches zero.
+  constexpr void AddRefs(std::size_t count) noexcept {
+    Policy::Add(use_ref_, count);
+  }
+
+  // The last strong reference destroys the object, unless the thread has a
+  // release sink that takes it; only objects shared across threads may be
+  // handed to another thread.
   constexpr void SubRef() noexcept {
-    if ((-- use_ref_) == 0) {
+    if (Policy::Decrement(use_ref_)) {
+      if constexpr (IsSameValue<Policy, AtomicRefPolicy>) {
+        auto *sink = shared_ptr_detail::release_sink;
+        if (sink != nullptr && sink->Defer(this, &RefCountBase::FinishRelease)) {
+          return;
+        }
+      }
       DestroyResource();
       SubWRef();
     }
   }
 
   constexpr void AddWRef() noexcept {
-    weak_ref_ ++;
+    Policy::Increment(weak_ref_);
   }
 
   constexpr void SubWRef() noexcept {
-    if ((-- weak_ref_) == 0) {
+    if (Policy::Decrement(weak_ref_)) {
       DeleteThis();
     }
   }
 
   constexpr bool TryAddRef() noexcept {
-    if (use_ref_ == 0) {
-      return false;
-    }
-    use_ref_ += 1;
-    return true;
+    return Policy::IncrementIfNonZero(use_ref_);
+  }
+
+  constexpr std::size_t UseCount() const noexcept {
+    return Policy::Load(use_ref_);
   }
 
-  constexpr void DestroyResource() noexcept {
+  // The managed object with its type erased, valid while a strong reference is held.
+  [[nodiscard]]
+  constexpr virtual void* GetResource() noexcept = 0;
+
+private:
+  static void FinishRelease(void *block) noexcept {
+    auto *self = static_cast<RefCountBase*>(block);
+    self->DestroyResource();
+    self->SubWRef();
+  }
+
+  // Destroys the managed object once the last strong reference is gone.
+  constexpr virtual void DestroyResource() noexcept = 0;
+
+  // Releases the control block itself once the last weak reference is gone.
+  constexpr virtual void DeleteThis() noexcept = 0;
+
+private:
+  typename Policy::CountType use_ref_{1};
+  typename Policy::CountType weak_ref_{1};
+};
+
+// Control block for a pointer adopted by 'SharedPtr(T*)', the object
+// and the block are two separate allocations.
+template <typename T, typename Policy>
+class RefCount final : public RefCountBase<Policy> {
+public:
+  constexpr explicit RefCount(T* ptr) noexcept : ptr_(ptr) {}
+
+  [[nodiscard]]
+  constexpr T* Get() const noexcept {
+    return ptr_;
+  }
+
+  [[nodiscard]]
+  constexpr void* GetResource() noexcept override {
+    return const_cast<std::remove_cv_t<T>*>(ptr_);
+  }
+
+private:
+  constexpr void DestroyResource() noexcept override {
     delete ptr_;
   }
 
-  constexpr void DeleteThis() noexcept {
+  constexpr void DeleteThis() noexcept override {
     delete this;
   }
 
-  constexpr std::size_t UseCount() const noexcept {
-    return use_ref_;
+private:
+  T* ptr_;
+};
+
+// Control block used by 'MakeShared', the object lives inside the block so
+// both share one allocation. The object is destroyed with the last strong
+// reference, the storage is freed with the last weak one.
+template <typename T, typename Policy>
+class RefCountInplace final : public RefCountBase<Policy> {
+public:
+  template <typename ...Args>
+  constexpr explicit RefCountInplace(Args &&...args) {
+    std::construct_at(std::addressof(value_), tystl::Forward<Args>(args)...);
   }
 
+  constexpr ~RefCountInplace() noexcept override {}
+
   [[nodiscard]]
-  constexpr T* Get() const noexcept {
-    return ptr_;
+  constexpr T* Get() noexcept {
+    return std::addressof(value_);
+  }
+
+  [[nodiscard]]
+  constexpr void* GetResource() noexcept override {
+    return const_cast<std::remove_cv_t<T>*>(Get());
+  }
+
+private:
+  constexpr void DestroyResource() noexcept override {
+    std::destroy_at(std::addressof(value_));
+  }
+
+  constexpr void DeleteThis() noexcept override {
+    delete this;
+  }
+
+private:
+  union {
+    T value_;
+  };
+};
+
+// Control block for a pointer adopted together with a custom deleter, the
+// block itself is placed in storage obtained from 'Alloc'.
+template <typename T, typename Deleter, typename Alloc, typename Policy>
+class RefCountDeleter final : public RefCountBase<Policy> {
+  using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<RefCountDeleter>;
+  using BlockTraits = std::allocator_traits<BlockAlloc>;
+
+public:
+  constexpr RefCountDeleter(T* ptr, Deleter deleter, const BlockAlloc &alloc) noexcept
+    : ptr_(ptr), deleter_(tystl::Move(deleter)), alloc_(alloc) {}
+
+  // If the block cannot be allocated the pointer is handed to the deleter
+  // before the exception propagates, so it never leaks.
+  [[nodiscard]]
+  static RefCountDeleter* Create(T* ptr, Deleter deleter, const Alloc &alloc) {
+    BlockAlloc block_alloc(alloc);
+    RefCountDeleter *block = nullptr;
+    try {
+      block = BlockTraits::allocate(block_alloc, 1);
+    } catch (...) {
+      deleter(ptr);
+      throw;
+    }
+    instrument::CountAllocation<T>(sizeof(RefCountDeleter));
+    return std::construct_at(block, ptr, tystl::Move(deleter), block_alloc);
+  }
+
+  [[nodiscard]]
+  constexpr void* GetResource() noexcept override {
+    return const_cast<std::remove_cv_t<T>*>(ptr_);
+  }
+
+private:
+  constexpr void DestroyResource() noexcept override {
+    deleter_(ptr_);
+  }
+
+  constexpr void DeleteThis() noexcept override {
+    BlockAlloc alloc(tystl::Move(alloc_));
+    std::destroy_at(this);
+    BlockTraits::deallocate(alloc, this, 1);
   }
 
 private:
-  std::atomic_size_t use_ref_{1};
-  std::atomic_size_t weak_ref_{1};
   T* ptr_;
+  [[no_unique_address]] Deleter deleter_;
+  [[no_unique_address]] BlockAlloc alloc_;
 };
 
-template <typename T>
+// Control block used by 'AllocateShared', like 'RefCountInplace' but both the
+// block and the object are placed in storage obtained from 'Alloc'.
+template <typename T, typename Alloc, typename Policy>
+class RefCountInplaceAlloc final : public RefCountBase<Policy> {
+  using ValueType = std::remove_cv_t<T>;
+  using ValueAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<ValueType>;
+  using ValueTraits = std::allocator_traits<ValueAlloc>;
+  using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<RefCountInplaceAlloc>;
+  using BlockTraits = std::allocator_traits<BlockAlloc>;
+
+public:
+  template <typename ...Args>
+  constexpr explicit RefCountInplaceAlloc(const Alloc &alloc, Args &&...args) : alloc_(alloc) {
+    ValueTraits::construct(alloc_, std::addressof(value_), tystl::Forward<Args>(args)...);
+  }
+
+  constexpr ~RefCountInplaceAlloc() noexcept override {}
+
+  template <typename ...Args>
+  [[nodiscard]]
+  static RefCountInplaceAlloc* Create(const Alloc &alloc, Args &&...args) {
+    BlockAlloc block_alloc(alloc);
+    auto *block = BlockTraits::allocate(block_alloc, 1);
+    instrument::CountAllocation<T>(sizeof(RefCountInplaceAlloc));
+    try {
+      return std::construct_at(block, alloc, tystl::Forward<Args>(args)...);
+    } catch (...) {
+      BlockTraits::deallocate(block_alloc, block, 1);
+      throw;
+    }
+  }
+
+  [[nodiscard]]
+  constexpr T* Get() noexcept {
+    return std::addressof(value_);
+  }
+
+  [[nodiscard]]
+  constexpr void* GetResource() noexcept override {
+    return std::addressof(value_);
+  }
+
+private:
+  constexpr void DestroyResource() noexcept override {
+    ValueTraits::destroy(alloc_, std::addressof(value_));
+  }
+
+  constexpr void DeleteThis() noexcept override {
+    BlockAlloc alloc(alloc_);
+    std::destroy_at(this);
+    BlockTraits::deallocate(alloc, this, 1);
+  }
+
+private:
+  [[no_unique_address]] ValueAlloc alloc_;
+  union {
+    ValueType value_;
+  };
+};
+
+template <typename T, typename Policy>
 class PtrBase {
 public:
   constexpr PtrBase() noexcept = default;
@@ -87,29 +397,36 @@ public:
   constexpr PtrBase& operator=(const PtrBase&) = delete;
 
   [[nodiscard]]
-  const T* Get() const noexcept {
-    if (ref_counter_ != nullptr) {
-      return ref_counter_->Get();
-    }
-    return nullptr;
+  constexpr T* Get() const noexcept {
+    return ptr_;
   }
 
   constexpr auto UseCount() const noexcept {
     return ref_counter_ ? ref_counter_->UseCount() : 0;
   }
 
-  template <typename T2>
-  constexpr void Swap(PtrBase<T2> &other) noexcept {
+  constexpr void Swap(PtrBase &other) noexcept {
+    tystl::Swap(ptr_, other.ptr_);
     tystl::Swap(ref_counter_, other.ref_counter_);
   }
 
 private:
-  friend class SharedPtr<T>;
-  friend class WeakPtr<T>;
+  template <typename, typename>
+  friend class PtrBase;
+
+  friend class SharedPtr<T, Policy>;
+  friend class WeakPtr<T, Policy>;
+  friend class AtomicSharedPtr<T, Policy>;
 
   constexpr void Init(T *ptr) {
     ptr_ = ptr;
-    ref_counter_ = new RefCount<T>(ptr);
+    ref_counter_ = new RefCount<T, Policy>(ptr);
+    instrument::CountAllocation<T>(sizeof(RefCount<T, Policy>));
+  }
+
+  constexpr void Init(T *ptr, RefCountBase<Policy> *ref_counter) noexcept {
+    ptr_ = ptr;
+    ref_counter_ = ref_counter;
   }
 
   constexpr void AddRef() const noexcept {
@@ -137,31 +454,31 @@ private:
   }
 
   template <typename T2>
-  constexpr void CopyPtrFrom(const PtrBase<T2> &other) noexcept {
+  constexpr void CopyPtrFrom(const PtrBase<T2, Policy> &other) noexcept {
     ptr_ = other.ptr_;
     ref_counter_ = other.ref_counter_;
   }
 
   template <typename T2>
-  constexpr void MoveConstructFrom(PtrBase<T2> &&other) noexcept {
+  constexpr void MoveConstructFrom(PtrBase<T2, Policy> &&other) noexcept {
     ptr_ = std::exchange(other.ptr_, nullptr);
-    ref_counter_ = std::exchange(other.ptr_, nullptr);
+    ref_counter_ = std::exchange(other.ref_counter_, nullptr);
   }
 
   template <typename T2>
-  constexpr void CopyConstructFromShared(const SharedPtr<T2> &other) noexcept {
+  constexpr void CopyConstructFromShared(const SharedPtr<T2, Policy> &other) noexcept {
     other.AddRef();
     CopyPtrFrom(other);
   }
 
   template <typename T2>
-  constexpr void WeaklyConstructFrom(const PtrBase<T2> &other) noexcept {
+  constexpr void WeaklyConstructFrom(const PtrBase<T2, Policy> &other) noexcept {
     CopyPtrFrom(other);
     AddWRef();
   }
 
   template <typename T2>
-  constexpr bool ConstructFromWeak(const WeakPtr<T2> &other) noexcept {
+  constexpr bool ConstructFromWeak(const WeakPtr<T2, Policy> &other) noexcept {
     if (other.ref_counter_ && other.ref_counter_->TryAddRef()) {
       CopyPtrFrom(other);
       return true;
@@ -171,17 +488,39 @@ private:
 
 private:
   T* ptr_ = nullptr;
-  RefCount<T>* ref_counter_ = nullptr;
+  RefCountBase<Policy>* ref_counter_ = nullptr;
 };
 
-template <typename T>
-class SharedPtr : public PtrBase<T> {
+template <typename T, typename Policy>
+class SharedPtr : public PtrBase<T, Policy> {
 private:
-  using Base = PtrBase<T>;
+  using Base = PtrBase<T, Policy>;
 
-  template <typename>
+  template <typename, typename>
   friend class EnableSharedFromThis;
 
+  template <typename T2, typename Policy2, typename ...Args>
+    requires std::is_constructible_v<T2, Args...>
+  friend constexpr SharedPtr<T2, Policy2> MakeShared(Args &&...args);
+
+  template <typename T2, typename Policy2, typename Alloc, typename ...Args>
+    requires std::is_constructible_v<T2, Args...>
+  friend SharedPtr<T2, Policy2> AllocateShared(const Alloc &alloc, Args &&...args);
+
+  // Adopts a control block that already holds one strong reference.
+  constexpr SharedPtr(T *ptr, RefCountBase<Policy> *ref_counter) noexcept {
+    Base::Init(ptr, ref_counter);
+    EnableSharedWith(ptr);
+  }
+
+  constexpr void EnableSharedWith(T *ptr) noexcept {
+    // If this class is derived from EnableSharedFromThis
+    // and then assign 'this' shared ptr to weak this ptr.
+    if constexpr (CanEnableShared<T, Policy>) {
+      ptr->weak_this_ = *this;
+    }
+  }
+
 public:
   constexpr SharedPtr() noexcept = default;
 
@@ -189,11 +528,22 @@ public:
 
   constexpr explicit SharedPtr(T *ptr) {
     Base::Init(ptr);
-    // If this class is derived from EnableSharedFromThis
-    // and then assign 'this' shared ptr to weak this ptr.
-    if constexpr (CanEnableShared<T>) {
-      ptr->weak_this_ = *this;
-    }
+    EnableSharedWith(ptr);
+  }
+
+  // 'deleter(ptr)' runs instead of 'delete ptr' once the last strong
+  // reference is gone.
+  template <typename Deleter>
+    requires std::is_invocable_v<Deleter&, T*>
+  SharedPtr(T *ptr, Deleter deleter)
+    : SharedPtr(ptr, tystl::Move(deleter), std::allocator<std::byte>()) {}
+
+  // As above, with the control block placed in storage from 'alloc'.
+  template <typename Deleter, typename Alloc>
+    requires std::is_invocable_v<Deleter&, T*>
+  SharedPtr(T *ptr, Deleter deleter, const Alloc &alloc) {
+    Base::Init(ptr, RefCountDeleter<T, Deleter, Alloc, Policy>::Create(ptr, tystl::Move(deleter), alloc));
+    EnableSharedWith(ptr);
   }
 
   constexpr SharedPtr(const SharedPtr &other) noexcept {
@@ -210,7 +560,7 @@ public:
   }
 
   template <typename T2>
-  constexpr SharedPtr(const WeakPtr<T2> &other) noexcept {
+  constexpr SharedPtr(const WeakPtr<T2, Policy> &other) noexcept {
     Base::ConstructFromWeak(other);
   }
 
@@ -235,15 +585,15 @@ public:
   }
 };
 
-template <typename T>
-class WeakPtr : public PtrBase<T> {
-  using Base = PtrBase<T>;
+template <typename T, typename Policy>
+class WeakPtr : public PtrBase<T, Policy> {
+  using Base = PtrBase<T, Policy>;
 public:
   constexpr WeakPtr() noexcept = default;
 
   constexpr WeakPtr(std::nullptr_t) noexcept {}
 
-  constexpr WeakPtr(const SharedPtr<T> &other) noexcept {
+  constexpr WeakPtr(const SharedPtr<T, Policy> &other) noexcept {
     Base::WeaklyConstructFrom(other);
   }
 
@@ -265,19 +615,19 @@ public:
   }
 
   [[nodiscard]]
-  constexpr SharedPtr<T> Lock() const noexcept {
-    SharedPtr<T> result;
+  constexpr SharedPtr<T, Policy> Lock() const noexcept {
+    SharedPtr<T, Policy> result;
     result.ConstructFromWeak(*this);
     return result;
   }
 
   [[nodiscard]]
   constexpr bool Expired() const noexcept {
-    return Base::ref_counter_->UseCount() == 0;
+    return Base::UseCount() == 0;
   }
 };
 
-template <typename T>
+template <typename T, typename Policy>
 class EnableSharedFromThis {
 protected:
   constexpr EnableSharedFromThis() noexcept : weak_this_() {}
@@ -291,26 +641,50 @@ protected:
   }
 
 public:
-  constexpr SharedPtr<T> SharedFromThis() {
-    return SharedPtr<T>(weak_this_);
+  constexpr SharedPtr<T, Policy> SharedFromThis() {
+    return SharedPtr<T, Policy>(weak_this_);
   }
 
-  constexpr SharedPtr<const T> SharedFromThis() const {
-    return SharedPtr<const T>(weak_this_);
+  constexpr SharedPtr<const T, Policy> SharedFromThis() const {
+    return SharedPtr<const T, Policy>(weak_this_);
   }
 
 private:
-  template <typename>
+  template <typename, typename>
   friend class SharedPtr;
 
-  mutable WeakPtr<T> weak_this_;
+  mutable WeakPtr<T, Policy> weak_this_;
 };
 
+// Both hold a pointer to the object and one to its control block, neither
+// of which refers back to the handle.
+template <typename T, typename Policy>
+struct IsTriviallyRelocatable<SharedPtr<T, Policy>> : std::true_type {};
+
+template <typename T, typename Policy>
+struct IsTriviallyRelocatable<WeakPtr<T, Policy>> : std::true_type {};
+
+// Allocates the object and its control block together.
+template <typename T, typename Policy = AtomicRefPolicy, typename ...Args>
+  requires std::is_constructible_v<T, Args...>
+constexpr SharedPtr<T, Policy> MakeShared(Args &&...args) {
+  auto *ref_counter = new RefCountInplace<T, Policy>(tystl::Forward<Args>(args)...);
+  instrument::CountAllocation<T>(sizeof(RefCountInplace<T, Policy>));
+  return SharedPtr<T, Policy>(ref_counter->Get(), ref_counter);
+}
+
+// Places the object and its control block in one allocation from 'alloc'.
+template <typename T, typename Policy = AtomicRefPolicy, typename Alloc, typename ...Args>
+  requires std::is_constructible_v<T, Args...>
+SharedPtr<T, Policy> AllocateShared(const Alloc &alloc, Args &&...args) {
+  auto *ref_counter = RefCountInplaceAlloc<T, Alloc, Policy>::Create(alloc, tystl::Forward<Args>(args)...);
+  return SharedPtr<T, Policy>(ref_counter->Get(), ref_counter);
+}
 
 template <typename T, typename ...Args>
   requires std::is_constructible_v<T, Args...>
-constexpr SharedPtr<T> MakeShared(Args &&...args) {
-  return SharedPtr<T>(new T(std::forward<Args>(args)...));
+constexpr LocalSharedPtr<T> MakeLocalShared(Args &&...args) {
+  return MakeShared<T, LocalRefPolicy>(tystl::Forward<Args>(args)...);
 }
 
 }
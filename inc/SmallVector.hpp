@@ -0,0 +1,529 @@
+#pragma once
+
+#include "GrowthPolicy.hpp"
+#include "Utility.hpp"
+#include "Vector.hpp"
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace tystl {
+
+// A Vector that keeps up to 'N' elements inside the object and only
+// allocates once it grows past them. Moving a SmallVector whose elements
+// are inline moves the elements and never allocates; one that has spilled
+// hands over its buffer like a Vector does.
+//
+// The inline buffer makes the object 'N * sizeof(T)' bytes larger, and
+// since 'Data()' may point into the object itself, a SmallVector is never
+// trivially relocatable.
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>, typename Growth = DefaultGrowth>
+  requires (N > 0)
+class SmallVector {
+  using AllocTraits = std::allocator_traits<Alloc>;
+
+public:
+  using value_type             = T;
+  using allocator_type         = Alloc;
+  using size_type              = std::size_t;
+  using difference_type        = std::ptrdiff_t;
+  using pointer                = T*;
+  using const_pointer          = const T*;
+  using reference              = T&;
+  using const_reference        = const T&;
+  using iterator               = T*;
+  using const_iterator         = const T*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type kInlineCapacity = N;
+
+  static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+
+public:
+  SmallVector() noexcept(noexcept(Alloc())) : alloc_() {}
+
+  explicit SmallVector(const Alloc &alloc) noexcept : alloc_(alloc) {}
+
+  explicit SmallVector(size_type count, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Resize(count);
+  }
+
+  SmallVector(size_type count, const T &value, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Resize(count, value);
+  }
+
+  template <std::input_iterator InputIt>
+  SmallVector(InputIt first, InputIt last, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Append(first, last);
+  }
+
+  SmallVector(std::initializer_list<T> init, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Append(init.begin(), init.end());
+  }
+
+  SmallVector(const SmallVector &other)
+      : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    this->Append(other.begin(), other.end());
+  }
+
+  SmallVector(SmallVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : alloc_(tystl::Move(other.alloc_)) {
+    this->TakeFrom(other);
+  }
+
+  SmallVector& operator=(const SmallVector &other) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+      if (alloc_ != other.alloc_) {
+        this->Deallocate();
+      }
+      alloc_ = other.alloc_;
+    }
+    this->Assign(other.begin(), other.end());
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (!AllocTraits::propagate_on_container_move_assignment::value &&
+                  !AllocTraits::is_always_equal::value) {
+      // A buffer from another allocator cannot be adopted, move the elements.
+      if (alloc_ != other.alloc_ && !other.IsInline()) {
+        this->Assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        other.Clear();
+        return *this;
+      }
+    }
+    this->Deallocate();
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+      alloc_ = tystl::Move(other.alloc_);
+    }
+    this->TakeFrom(other);
+    return *this;
+  }
+
+  SmallVector& operator=(std::initializer_list<T> init) {
+    this->Assign(init.begin(), init.end());
+    return *this;
+  }
+
+  ~SmallVector() {
+    this->Deallocate();
+  }
+
+  void Swap(SmallVector &other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    SmallVector tmp = tystl::Move(other);
+    other = tystl::Move(*this);
+    *this = tystl::Move(tmp);
+  }
+
+public:
+  [[nodiscard]]
+  allocator_type GetAllocator() const noexcept {
+    return alloc_;
+  }
+
+  // Whether the elements are still in the inline buffer.
+  [[nodiscard]]
+  bool IsInline() const noexcept {
+    return data_ == this->InlineData();
+  }
+
+  [[nodiscard]]
+  size_type Size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]]
+  size_type Capacity() const noexcept {
+    return capacity_;
+  }
+
+  [[nodiscard]]
+  size_type MaxSize() const noexcept {
+    return AllocTraits::max_size(alloc_);
+  }
+
+  [[nodiscard]]
+  bool Empty() const noexcept {
+    return size_ == 0;
+  }
+
+  [[nodiscard]]
+  reference At(size_type pos) {
+    if (size_ <= pos) {
+      throw std::out_of_range("SmallVector::At");
+    }
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  const_reference At(size_type pos) const {
+    if (size_ <= pos) {
+      throw std::out_of_range("SmallVector::At");
+    }
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  reference operator[](size_type pos) noexcept {
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  const_reference operator[](size_type pos) const noexcept {
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  reference Front() noexcept {
+    return data_[0];
+  }
+
+  [[nodiscard]]
+  const_reference Front() const noexcept {
+    return data_[0];
+  }
+
+  [[nodiscard]]
+  reference Back() noexcept {
+    return data_[size_ - 1];
+  }
+
+  [[nodiscard]]
+  const_reference Back() const noexcept {
+    return data_[size_ - 1];
+  }
+
+  [[nodiscard]]
+  pointer Data() noexcept {
+    return data_;
+  }
+
+  [[nodiscard]]
+  const_pointer Data() const noexcept {
+    return data_;
+  }
+
+  void Reserve(size_type capacity) {
+    if (capacity > capacity_) {
+      this->Reallocate(this->CheckedCapacity(capacity));
+    }
+  }
+
+  // Drops unused heap capacity, moving the elements back inline if they fit.
+  void ShrinkToFit() {
+    if (this->IsInline() || size_ == capacity_) {
+      return;
+    }
+    if (size_ <= N) {
+      auto *inline_data = this->InlineData();
+      vector_detail::Relocate(alloc_, data_, size_, inline_data);
+      this->ReleaseBuffer();
+      data_ = inline_data;
+      capacity_ = N;
+    } else {
+      this->Reallocate(size_);
+    }
+  }
+
+  void Clear() noexcept {
+    vector_detail::DestroyRange(alloc_, data_, data_ + size_);
+    size_ = 0;
+  }
+
+  void Resize(size_type count) {
+    this->ResizeWith(count, [&](T *slot) { AllocTraits::construct(alloc_, slot); });
+  }
+
+  void Resize(size_type count, const T &value) {
+    this->ResizeWith(count, [&](T *slot) { AllocTraits::construct(alloc_, slot, value); });
+  }
+
+  template <typename ...Args>
+    requires std::is_constructible_v<T, Args...>
+  reference EmplaceBack(Args &&...args) {
+    if (size_ != capacity_) [[likely]] {
+      AllocTraits::construct(alloc_, data_ + size_, tystl::Forward<Args>(args)...);
+      return data_[size_++];
+    }
+    return this->EmplaceBackGrow(tystl::Forward<Args>(args)...);
+  }
+
+  void PushBack(const T &value) {
+    this->EmplaceBack(value);
+  }
+
+  void PushBack(T &&value) {
+    this->EmplaceBack(tystl::Move(value));
+  }
+
+  void PopBack() noexcept {
+    AllocTraits::destroy(alloc_, data_ + --size_);
+  }
+
+  // Constructs an element in front of 'pos' and returns an iterator to it.
+  template <typename ...Args>
+    requires std::is_constructible_v<T, Args...>
+  iterator Emplace(const_iterator pos, Args &&...args) {
+    auto index = static_cast<size_type>(pos - data_);
+    this->EmplaceBack(tystl::Forward<Args>(args)...);
+    vector_detail::RotateIntoPlace(data_ + index, data_ + size_ - 1);
+    return data_ + index;
+  }
+
+  iterator Insert(const_iterator pos, const T &value) {
+    return this->Emplace(pos, value);
+  }
+
+  iterator Insert(const_iterator pos, T &&value) {
+    return this->Emplace(pos, tystl::Move(value));
+  }
+
+  iterator Erase(const_iterator pos) {
+    return this->Erase(pos, pos + 1);
+  }
+
+  iterator Erase(const_iterator first, const_iterator last) {
+    auto *begin = data_ + (first - data_);
+    auto *stop = vector_detail::EraseRange(alloc_, begin, data_ + (last - data_), data_ + size_);
+    size_ = static_cast<size_type>(stop - data_);
+    return begin;
+  }
+
+  template <std::input_iterator InputIt>
+  void Assign(InputIt first, InputIt last) {
+    this->Clear();
+    this->Append(first, last);
+  }
+
+  [[nodiscard]]
+  bool operator==(const SmallVector &right) const {
+    return std::equal(begin(), end(), right.begin(), right.end());
+  }
+
+  [[nodiscard]]
+  auto operator<=>(const SmallVector &right) const
+    requires std::three_way_comparable<T> {
+    return std::lexicographical_compare_three_way(begin(), end(), right.begin(), right.end());
+  }
+
+public:
+  iterator begin() noexcept {
+    return data_;
+  }
+
+  const_iterator begin() const noexcept {
+    return data_;
+  }
+
+  iterator end() noexcept {
+    return data_ + size_;
+  }
+
+  const_iterator end() const noexcept {
+    return data_ + size_;
+  }
+
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  reference front() noexcept {
+    return this->Front();
+  }
+
+  const_reference front() const noexcept {
+    return this->Front();
+  }
+
+  reference back() noexcept {
+    return this->Back();
+  }
+
+  const_reference back() const noexcept {
+    return this->Back();
+  }
+
+  void push_back(const T &value) {
+    this->EmplaceBack(value);
+  }
+
+  void push_back(T &&value) {
+    this->EmplaceBack(tystl::Move(value));
+  }
+
+  template <typename ...Args>
+  reference emplace_back(Args &&...args) {
+    return this->EmplaceBack(tystl::Forward<Args>(args)...);
+  }
+
+  void pop_back() noexcept {
+    this->PopBack();
+  }
+
+private:
+  T* InlineData() noexcept {
+    return reinterpret_cast<T*>(buffer_);
+  }
+
+  const T* InlineData() const noexcept {
+    return reinterpret_cast<const T*>(buffer_);
+  }
+
+  // Takes the elements of 'other' while this SmallVector is empty and inline.
+  void TakeFrom(SmallVector &other) {
+    if (other.IsInline()) {
+      vector_detail::Relocate(alloc_, other.data_, other.size_, data_);
+      size_ = std::exchange(other.size_, 0);
+      return;
+    }
+    data_ = std::exchange(other.data_, other.InlineData());
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, N);
+  }
+
+  size_type CheckedCapacity(size_type capacity) const {
+    if (capacity > this->MaxSize()) {
+      throw std::length_error("SmallVector");
+    }
+    return capacity;
+  }
+
+  size_type NextCapacity(size_type required) const {
+    return this->CheckedCapacity(Growth::Grow(capacity_, required));
+  }
+
+  void Reallocate(size_type capacity) {
+    auto *data = AllocTraits::allocate(alloc_, capacity);
+    try {
+      vector_detail::Relocate(alloc_, data_, size_, data);
+    } catch (...) {
+      AllocTraits::deallocate(alloc_, data, capacity);
+      throw;
+    }
+    this->ReleaseBuffer();
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  // The new element is built in the new buffer before the old elements are
+  // moved, so 'args' may refer to an element of this SmallVector.
+  template <typename ...Args>
+  reference EmplaceBackGrow(Args &&...args) {
+    auto capacity = this->NextCapacity(size_ + 1);
+    auto *data = AllocTraits::allocate(alloc_, capacity);
+    try {
+      AllocTraits::construct(alloc_, data + size_, tystl::Forward<Args>(args)...);
+    } catch (...) {
+      AllocTraits::deallocate(alloc_, data, capacity);
+      throw;
+    }
+    try {
+      vector_detail::Relocate(alloc_, data_, size_, data);
+    } catch (...) {
+      AllocTraits::destroy(alloc_, data + size_);
+      AllocTraits::deallocate(alloc_, data, capacity);
+      throw;
+    }
+    this->ReleaseBuffer();
+    data_ = data;
+    capacity_ = capacity;
+    return data_[size_++];
+  }
+
+  template <typename Construct>
+  void ResizeWith(size_type count, Construct construct) {
+    if (count <= size_) {
+      vector_detail::DestroyRange(alloc_, data_ + count, data_ + size_);
+      size_ = count;
+      return;
+    }
+    if (count > capacity_) {
+      this->Reallocate(this->NextCapacity(count));
+    }
+    for (; size_ < count; size_++) {
+      construct(data_ + size_);
+    }
+  }
+
+  template <typename InputIt>
+  void Append(InputIt first, InputIt last) {
+    if constexpr (std::forward_iterator<InputIt>) {
+      auto count = static_cast<size_type>(std::distance(first, last));
+      if (size_ + count > capacity_) {
+        this->Reallocate(this->NextCapacity(size_ + count));
+      }
+      for (; first != last; ++first) {
+        AllocTraits::construct(alloc_, data_ + size_, *first);
+        size_++;
+      }
+    } else {
+      for (; first != last; ++first) {
+        this->EmplaceBack(*first);
+      }
+    }
+  }
+
+  // Frees a heap buffer without destroying the elements it held.
+  void ReleaseBuffer() noexcept {
+    if (!this->IsInline()) {
+      AllocTraits::deallocate(alloc_, data_, capacity_);
+    }
+  }
+
+  // Destroys the elements and returns to the inline buffer.
+  void Deallocate() noexcept {
+    this->Clear();
+    this->ReleaseBuffer();
+    data_ = this->InlineData();
+    capacity_ = N;
+  }
+
+private:
+  T *data_ = this->InlineData();
+  size_type size_ = 0;
+  size_type capacity_ = N;
+  [[no_unique_address]] Alloc alloc_;
+  alignas(T) unsigned char buffer_[N * sizeof(T)];
+};
+
+}
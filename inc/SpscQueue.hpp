@@ -0,0 +1,199 @@
+#pragma once
+
+#include "Array.hpp"
+#include "Backoff.hpp"
+#include "Utility.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace tystl {
+
+// Uninitialized storage for one element of a ring buffer.
+template <typename T>
+struct alignas(T) RingSlot {
+  unsigned char bytes[sizeof(T)];
+
+  T* Get() noexcept {
+    return std::launder(reinterpret_cast<T*>(bytes));
+  }
+};
+
+// A bounded queue for exactly one producer and one consumer thread. The
+// 'N' slots live inline in an Array, so a large queue should not be put on
+// the stack.
+//
+// Head and tail sit on their own cache lines, each next to the other side's
+// last seen copy of the opposite index. A side reloads the other's index
+// only when its copy says the queue is full or empty, so in steady state
+// an operation touches no cache line written by the other thread but the
+// slot itself.
+template <typename T, std::size_t N>
+  requires (N >= 2 && std::has_single_bit(N))
+class SpscQueue {
+public:
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue &) = delete;
+
+  SpscQueue& operator=(const SpscQueue &) = delete;
+
+  ~SpscQueue() {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    for (auto head = head_.load(std::memory_order_relaxed); head != tail; head++) {
+      std::destroy_at(slots_[head & kMask].Get());
+    }
+  }
+
+public:
+  static constexpr auto Capacity() noexcept -> std::size_t { return N; }
+
+  // Approximate unless called from the producer or the consumer thread.
+  auto Size() const noexcept -> std::size_t {
+    auto tail = tail_.load(std::memory_order_acquire);
+    auto head = head_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  auto Empty() const noexcept -> bool { return this->Size() == 0; }
+
+  // Producer side. Returns false, leaving 'value' alone, if the queue is full.
+  auto TryPush(const T &value) -> bool {
+    return this->TryEmplace(value);
+  }
+
+  auto TryPush(T &&value) -> bool {
+    return this->TryEmplace(tystl::Move(value));
+  }
+
+  // Builds the element in its slot. The arguments are not touched if the
+  // queue is full.
+  template <typename... Ts>
+    requires std::is_constructible_v<T, Ts...>
+  auto TryEmplace(Ts &&...args) -> bool {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == N) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == N) {
+        return false;
+      }
+    }
+    std::construct_at(slots_[tail & kMask].Get(), tystl::Forward<Ts>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Waits while the queue is full.
+  auto Push(T value) -> void {
+    Backoff backoff;
+    while (!this->TryPush(tystl::Move(value))) {
+      backoff.Pause();
+    }
+  }
+
+  // Builds the element in its slot once there is room. A full queue leaves
+  // the arguments alone, so they are forwarded again on every attempt.
+  template <typename... Ts>
+    requires std::is_constructible_v<T, Ts...>
+  auto Emplace(Ts &&...args) -> void {
+    Backoff backoff;
+    while (!this->TryEmplace(tystl::Forward<Ts>(args)...)) {
+      backoff.Pause();
+    }
+  }
+
+  // Pushes up to 'count' elements built from 'first', publishing them with
+  // a single store, and returns how many fit. Pass a move iterator to move
+  // the elements in.
+  template <std::input_iterator It>
+    requires std::is_constructible_v<T, std::iter_reference_t<It>>
+  auto PushN(It first, std::size_t count) -> std::size_t {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (N - (tail - cached_head_) < count) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+    }
+    auto room = N - (tail - cached_head_);
+    count = count < room ? count : room;
+    std::size_t done = 0;
+    try {
+      for (; done < count; done++, ++first) {
+        std::construct_at(slots_[(tail + done) & kMask].Get(), *first);
+      }
+    } catch (...) {
+      tail_.store(tail + done, std::memory_order_release);
+      throw;
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // Consumer side. Moves the oldest element into 'out', or returns false if
+  // the queue is empty.
+  auto TryPop(T &out) -> bool {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return false;
+      }
+    }
+    auto *slot = slots_[head & kMask].Get();
+    out = tystl::Move(*slot);
+    std::destroy_at(slot);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Waits while the queue is empty.
+  auto Pop(T &out) -> void {
+    Backoff backoff;
+    while (!this->TryPop(out)) {
+      backoff.Pause();
+    }
+  }
+
+  // Moves up to 'count' elements to 'out', freeing their slots with a single
+  // store, and returns how many there were.
+  template <std::output_iterator<T&&> OutIt>
+  auto PopN(OutIt out, std::size_t count) -> std::size_t {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ - head < count) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+    auto available = cached_tail_ - head;
+    count = count < available ? count : available;
+    std::size_t done = 0;
+    try {
+      for (; done < count; done++) {
+        auto *slot = slots_[(head + done) & kMask].Get();
+        *out = tystl::Move(*slot);
+        ++out;
+        std::destroy_at(slot);
+      }
+    } catch (...) {
+      head_.store(head + done, std::memory_order_release);
+      throw;
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+private:
+  static constexpr std::size_t kMask = N - 1;
+
+  // Written by the consumer.
+  alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};
+  std::size_t cached_tail_ = 0;
+
+  // Written by the producer.
+  alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};
+  std::size_t cached_head_ = 0;
+
+  alignas(kCacheLineSize) Array<RingSlot<T>, N> slots_;
+};
+
+}
@@ -0,0 +1,733 @@
+#pragma once
+
+#include "GrowthPolicy.hpp"
+#include "Hash.hpp"
+#include "StringView.hpp"
+#include "TypeTraits.hpp"
+#include "Utility.hpp"
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace tystl {
+
+// A growable, null terminated run of characters. Strings of up to
+// 'kShortCapacity' characters, 23 on a 64 bit target, live inside the
+// three words of the object and never allocate; longer ones move to a heap
+// buffer whose capacity grows as 'Growth' says (see GrowthPolicy.hpp), the
+// same as Vector's.
+//
+// The last byte of the object tells the two apart. An inline string keeps
+// its unused capacity there, so a full one ends in the zero that
+// terminates it; a heap string keeps its capacity in the last word with
+// the top bit of that byte set. Nothing points into the object, so a
+// String is trivially relocatable.
+template <typename Alloc = std::allocator<char>, typename Growth = DefaultGrowth>
+class BasicString {
+  using AllocTraits = std::allocator_traits<Alloc>;
+
+public:
+  using value_type             = char;
+  using allocator_type         = Alloc;
+  using size_type              = std::size_t;
+  using difference_type        = std::ptrdiff_t;
+  using pointer                = char*;
+  using const_pointer          = const char*;
+  using reference              = char&;
+  using const_reference        = const char&;
+  using iterator               = char*;
+  using const_iterator         = const char*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type npos = StringView::npos;
+
+  static_assert(std::is_same_v<typename AllocTraits::value_type, char>);
+
+private:
+  struct Heap {
+    char *data;
+    size_type size;
+    size_type capacity;
+  };
+
+public:
+  static constexpr size_type kShortCapacity = sizeof(Heap) - 1;
+
+private:
+  struct Inline {
+    char data[kShortCapacity];
+    unsigned char spare;
+  };
+
+  static_assert(sizeof(Inline) == sizeof(Heap));
+
+  static constexpr unsigned char kHeapFlag = 0x80;
+
+  static_assert(kShortCapacity < kHeapFlag);
+
+public:
+  BasicString() noexcept(noexcept(Alloc())) : alloc_() {}
+
+  explicit BasicString(const Alloc &alloc) noexcept : alloc_(alloc) {}
+
+  BasicString(const char *str, const Alloc &alloc = Alloc()) : BasicString(StringView(str), alloc) {}
+
+  BasicString(const char *data, size_type size, const Alloc &alloc = Alloc())
+      : BasicString(StringView(data, size), alloc) {}
+
+  BasicString(size_type count, char ch, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Append(count, ch);
+  }
+
+  // Explicit, like std::string's, so a copy is never made by accident.
+  explicit BasicString(StringView str, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Init(str);
+  }
+
+  BasicString(std::nullptr_t) = delete;
+
+  BasicString(const BasicString &other)
+      : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    if (other.IsInline()) {
+      rep_ = other.rep_;
+    } else {
+      this->Init(other.View());
+    }
+  }
+
+  BasicString(BasicString &&other) noexcept : alloc_(tystl::Move(other.alloc_)) {
+    this->TakeFrom(other);
+  }
+
+  BasicString& operator=(const BasicString &other) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+      if (alloc_ != other.alloc_) {
+        this->Deallocate();
+      }
+      alloc_ = other.alloc_;
+    }
+    return this->Assign(other.View());
+  }
+
+  BasicString& operator=(BasicString &&other) noexcept(AllocTraits::propagate_on_container_move_assignment::value ||
+                                                       AllocTraits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (!AllocTraits::propagate_on_container_move_assignment::value &&
+                  !AllocTraits::is_always_equal::value) {
+      // A buffer from another allocator cannot be adopted, copy the characters.
+      if (alloc_ != other.alloc_) {
+        this->Assign(other.View());
+        other.Clear();
+        return *this;
+      }
+    }
+    this->Deallocate();
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+      alloc_ = tystl::Move(other.alloc_);
+    }
+    this->TakeFrom(other);
+    return *this;
+  }
+
+  BasicString& operator=(StringView str) {
+    return this->Assign(str);
+  }
+
+  BasicString& operator=(const char *str) {
+    return this->Assign(StringView(str));
+  }
+
+  BasicString& operator=(std::nullptr_t) = delete;
+
+  ~BasicString() {
+    this->Deallocate();
+  }
+
+  void Swap(BasicString &other) noexcept {
+    tystl::Swap(rep_, other.rep_);
+    if constexpr (AllocTraits::propagate_on_container_swap::value) {
+      tystl::Swap(alloc_, other.alloc_);
+    }
+  }
+
+public:
+  [[nodiscard]]
+  allocator_type GetAllocator() const noexcept {
+    return alloc_;
+  }
+
+  // Whether the characters are still inside the object.
+  [[nodiscard]]
+  bool IsInline() const noexcept {
+    return (this->LastByte() & kHeapFlag) == 0;
+  }
+
+  [[nodiscard]]
+  size_type Size() const noexcept {
+    return this->IsInline() ? kShortCapacity - rep_.local.spare : rep_.heap.size;
+  }
+
+  // Characters that fit without reallocating, not counting the terminator.
+  [[nodiscard]]
+  size_type Capacity() const noexcept {
+    return this->IsInline() ? kShortCapacity : DecodeCapacity(rep_.heap.capacity);
+  }
+
+  [[nodiscard]]
+  size_type MaxSize() const noexcept {
+    return std::min<size_type>(AllocTraits::max_size(alloc_), kMaxCapacity + 1) - 1;
+  }
+
+  [[nodiscard]]
+  bool Empty() const noexcept {
+    return this->Size() == 0;
+  }
+
+  [[nodiscard]]
+  char* Data() noexcept {
+    return this->IsInline() ? rep_.local.data : rep_.heap.data;
+  }
+
+  [[nodiscard]]
+  const char* Data() const noexcept {
+    return this->IsInline() ? rep_.local.data : rep_.heap.data;
+  }
+
+  // Same as 'Data', always followed by a zero.
+  [[nodiscard]]
+  const char* CStr() const noexcept {
+    return this->Data();
+  }
+
+  [[nodiscard]]
+  StringView View() const noexcept {
+    return StringView(this->Data(), this->Size());
+  }
+
+  operator StringView() const noexcept {
+    return this->View();
+  }
+
+  operator std::string_view() const noexcept {
+    return std::string_view(this->Data(), this->Size());
+  }
+
+  [[nodiscard]]
+  char& At(size_type pos) {
+    if (this->Size() <= pos) {
+      throw std::out_of_range("String::At");
+    }
+    return this->Data()[pos];
+  }
+
+  [[nodiscard]]
+  const char& At(size_type pos) const {
+    if (this->Size() <= pos) {
+      throw std::out_of_range("String::At");
+    }
+    return this->Data()[pos];
+  }
+
+  [[nodiscard]]
+  char& operator[](size_type pos) noexcept {
+    return this->Data()[pos];
+  }
+
+  [[nodiscard]]
+  const char& operator[](size_type pos) const noexcept {
+    return this->Data()[pos];
+  }
+
+  [[nodiscard]]
+  char& Front() noexcept {
+    return this->Data()[0];
+  }
+
+  [[nodiscard]]
+  const char& Front() const noexcept {
+    return this->Data()[0];
+  }
+
+  [[nodiscard]]
+  char& Back() noexcept {
+    return this->Data()[this->Size() - 1];
+  }
+
+  [[nodiscard]]
+  const char& Back() const noexcept {
+    return this->Data()[this->Size() - 1];
+  }
+
+  // Makes room for at least 'capacity' characters, so a string that is
+  // built to a known length allocates once.
+  void Reserve(size_type capacity) {
+    if (capacity > this->Capacity()) {
+      this->Reallocate(this->CheckedCapacity(capacity));
+    }
+  }
+
+  // Drops unused heap capacity, moving the characters back inline if they
+  // fit.
+  void ShrinkToFit() {
+    if (this->IsInline()) {
+      return;
+    }
+    auto size = rep_.heap.size;
+    if (size <= kShortCapacity) {
+      auto heap = rep_.heap;
+      this->SetInline(heap.data, size);
+      AllocTraits::deallocate(alloc_, heap.data, DecodeCapacity(heap.capacity) + 1);
+    } else if (size < DecodeCapacity(rep_.heap.capacity)) {
+      this->Reallocate(size);
+    }
+  }
+
+  // Keeps the capacity.
+  void Clear() noexcept {
+    this->SetSize(0);
+  }
+
+  void Resize(size_type count, char ch = '\0') {
+    auto size = this->Size();
+    if (count <= size) {
+      this->SetSize(count);
+    } else {
+      this->Append(count - size, ch);
+    }
+  }
+
+  void PushBack(char ch) {
+    auto size = this->Size();
+    if (size == this->Capacity()) [[unlikely]] {
+      this->Reallocate(this->NextCapacity(size + 1));
+    }
+    this->Data()[size] = ch;
+    this->SetSize(size + 1);
+  }
+
+  void PopBack() noexcept {
+    this->SetSize(this->Size() - 1);
+  }
+
+  // 'str' may be part of this String.
+  BasicString& Append(StringView str) {
+    auto count = str.Size();
+    if (this->IsInline()) {
+      auto size = kShortCapacity - rep_.local.spare;
+      if (count <= kShortCapacity - size) {
+        string_detail::Copy(rep_.local.data + size, str.Data(), count);
+        this->SetInlineSize(size + count);
+        return *this;
+      }
+    } else {
+      auto size = rep_.heap.size;
+      if (count <= DecodeCapacity(rep_.heap.capacity) - size) {
+        string_detail::Copy(rep_.heap.data + size, str.Data(), count);
+        rep_.heap.size = size + count;
+        rep_.heap.data[size + count] = '\0';
+        return *this;
+      }
+    }
+    this->AppendGrow(str);
+    return *this;
+  }
+
+  BasicString& Append(size_type count, char ch) {
+    auto size = this->Size();
+    if (count > this->Capacity() - size) {
+      this->Reallocate(this->NextCapacity(this->CheckedSize(size, count)));
+    }
+    std::memset(this->Data() + size, ch, count);
+    this->SetSize(size + count);
+    return *this;
+  }
+
+  BasicString& operator+=(StringView str) {
+    return this->Append(str);
+  }
+
+  BasicString& operator+=(char ch) {
+    this->PushBack(ch);
+    return *this;
+  }
+
+  // Replaces the contents with 'str', which may be part of this String.
+  BasicString& Assign(StringView str) {
+    auto count = str.Size();
+    if (count <= this->Capacity()) {
+      string_detail::Move(this->Data(), str.Data(), count);
+      this->SetSize(count);
+    } else {
+      BasicString tmp(alloc_);
+      tmp.Reallocate(this->CheckedCapacity(count));
+      tmp.Append(str);
+      this->Swap(tmp);
+    }
+    return *this;
+  }
+
+  // Inserts 'str' in front of 'pos'. Throws std::out_of_range if 'pos' is
+  // past the end.
+  BasicString& Insert(size_type pos, StringView str) {
+    auto size = this->Size();
+    if (pos > size) {
+      throw std::out_of_range("String::Insert");
+    }
+    auto count = str.Size();
+    const auto *data = this->Data();
+    if (count > this->Capacity() - size || (str.Data() >= data && str.Data() < data + size)) {
+      // Builds the result aside when it grows or 'str' would move under us.
+      BasicString tmp(alloc_);
+      tmp.Reserve(this->CheckedSize(size, count));
+      tmp.Append(StringView(data, pos)).Append(str).Append(StringView(data + pos, size - pos));
+      this->Swap(tmp);
+      return *this;
+    }
+    auto *target = this->Data();
+    string_detail::Move(target + pos + count, target + pos, size - pos);
+    string_detail::Copy(target + pos, str.Data(), count);
+    this->SetSize(size + count);
+    return *this;
+  }
+
+  // Removes up to 'count' characters from 'pos'. Throws std::out_of_range
+  // if 'pos' is past the end.
+  BasicString& Erase(size_type pos, size_type count = npos) {
+    auto size = this->Size();
+    if (pos > size) {
+      throw std::out_of_range("String::Erase");
+    }
+    count = std::min(count, size - pos);
+    auto *data = this->Data();
+    string_detail::Move(data + pos, data + pos + count, size - pos - count);
+    this->SetSize(size - count);
+    return *this;
+  }
+
+  [[nodiscard]]
+  BasicString Substr(size_type pos, size_type count = npos) const {
+    return BasicString(this->View().Substr(pos, count), alloc_);
+  }
+
+  [[nodiscard]]
+  size_type Find(char ch, size_type pos = 0) const noexcept {
+    return this->View().Find(ch, pos);
+  }
+
+  [[nodiscard]]
+  size_type Find(StringView str, size_type pos = 0) const noexcept {
+    return this->View().Find(str, pos);
+  }
+
+  [[nodiscard]]
+  size_type RFind(char ch, size_type pos = npos) const noexcept {
+    return this->View().RFind(ch, pos);
+  }
+
+  [[nodiscard]]
+  size_type RFind(StringView str, size_type pos = npos) const noexcept {
+    return this->View().RFind(str, pos);
+  }
+
+  [[nodiscard]]
+  bool Contains(char ch) const noexcept {
+    return this->View().Contains(ch);
+  }
+
+  [[nodiscard]]
+  bool Contains(StringView str) const noexcept {
+    return this->View().Contains(str);
+  }
+
+  [[nodiscard]]
+  bool StartsWith(StringView prefix) const noexcept {
+    return this->View().StartsWith(prefix);
+  }
+
+  [[nodiscard]]
+  bool EndsWith(StringView suffix) const noexcept {
+    return this->View().EndsWith(suffix);
+  }
+
+  [[nodiscard]]
+  int Compare(StringView other) const noexcept {
+    return this->View().Compare(other);
+  }
+
+  // Equal to the hash of a StringView of the same characters.
+  [[nodiscard]]
+  std::uint64_t Hash() const noexcept {
+    return this->View().Hash();
+  }
+
+  // One overload serves every right side: a String compared with a String
+  // prefers this over the same call reversed.
+  [[nodiscard]]
+  friend bool operator==(const BasicString &left, StringView right) noexcept {
+    return left.View() == right;
+  }
+
+  [[nodiscard]]
+  friend std::strong_ordering operator<=>(const BasicString &left, StringView right) noexcept {
+    return left.View() <=> right;
+  }
+
+  [[nodiscard]]
+  friend BasicString operator+(const BasicString &left, StringView right) {
+    BasicString result(left.alloc_);
+    result.Reserve(left.CheckedSize(left.Size(), right.Size()));
+    result.Append(left.View()).Append(right);
+    return result;
+  }
+
+  [[nodiscard]]
+  friend BasicString operator+(BasicString &&left, StringView right) {
+    left.Append(right);
+    return tystl::Move(left);
+  }
+
+public:
+  iterator begin() noexcept {
+    return this->Data();
+  }
+
+  const_iterator begin() const noexcept {
+    return this->Data();
+  }
+
+  iterator end() noexcept {
+    return this->Data() + this->Size();
+  }
+
+  const_iterator end() const noexcept {
+    return this->Data() + this->Size();
+  }
+
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  char* data() noexcept {
+    return this->Data();
+  }
+
+  const char* data() const noexcept {
+    return this->Data();
+  }
+
+  const char* c_str() const noexcept {
+    return this->Data();
+  }
+
+  size_type size() const noexcept {
+    return this->Size();
+  }
+
+  bool empty() const noexcept {
+    return this->Empty();
+  }
+
+  void push_back(char ch) {
+    this->PushBack(ch);
+  }
+
+  void pop_back() noexcept {
+    this->PopBack();
+  }
+
+private:
+  // The capacity word of a heap string, with the flag in the top bit of
+  // the object's last byte whichever the byte order.
+  static constexpr bool kLittleEndian = std::endian::native == std::endian::little;
+
+  static constexpr size_type kMaxCapacity = ~size_type{0} >> 8;
+
+  static constexpr size_type EncodeCapacity(size_type capacity) noexcept {
+    if constexpr (kLittleEndian) {
+      return capacity | (size_type{kHeapFlag} << (8 * (sizeof(size_type) - 1)));
+    } else {
+      return (capacity << 8) | kHeapFlag;
+    }
+  }
+
+  static constexpr size_type DecodeCapacity(size_type encoded) noexcept {
+    if constexpr (kLittleEndian) {
+      return encoded & kMaxCapacity;
+    } else {
+      return encoded >> 8;
+    }
+  }
+
+  unsigned char LastByte() const noexcept {
+    return reinterpret_cast<const unsigned char*>(&rep_)[sizeof(rep_) - 1];
+  }
+
+  void SetInlineSize(size_type size) noexcept {
+    rep_.local.spare = static_cast<unsigned char>(kShortCapacity - size);
+    if (size != kShortCapacity) {
+      rep_.local.data[size] = '\0';
+    }
+  }
+
+  void SetSize(size_type size) noexcept {
+    if (this->IsInline()) {
+      this->SetInlineSize(size);
+    } else {
+      rep_.heap.size = size;
+      rep_.heap.data[size] = '\0';
+    }
+  }
+
+  // Copies 'size' characters at 'data' inline, forgetting any heap buffer.
+  void SetInline(const char *data, size_type size) noexcept {
+    char copy[kShortCapacity];
+    string_detail::Copy(copy, data, size);
+    rep_.local = Inline{};
+    string_detail::Copy(rep_.local.data, copy, size);
+    rep_.local.spare = static_cast<unsigned char>(kShortCapacity);
+    this->SetSize(size);
+  }
+
+  // The size of 'size + count' characters, if a String can hold that many.
+  size_type CheckedSize(size_type size, size_type count) const {
+    if (count > this->MaxSize() - size) {
+      throw std::length_error("String");
+    }
+    return size + count;
+  }
+
+  size_type CheckedCapacity(size_type capacity) const {
+    if (capacity > this->MaxSize()) {
+      throw std::length_error("String");
+    }
+    return capacity;
+  }
+
+  size_type NextCapacity(size_type required) const {
+    return this->CheckedCapacity(Growth::Grow(this->Capacity(), required));
+  }
+
+  // Takes the characters of 'other', which is left empty and inline.
+  void TakeFrom(BasicString &other) noexcept {
+    rep_ = other.rep_;
+    other.rep_ = Rep();
+  }
+
+  // Allocates room for at least 'capacity' characters and the terminator,
+  // rounded up to the 16 bytes that allocators hand out anyway, and
+  // updates 'capacity' to match.
+  char* AllocateBuffer(size_type &capacity) {
+    capacity = ((capacity + 16) & ~size_type{15}) - 1;
+    return AllocTraits::allocate(alloc_, capacity + 1);
+  }
+
+  // Fills a new, empty String with 'str', with no more capacity than it
+  // needs.
+  void Init(StringView str) {
+    auto size = str.Size();
+    if (size <= kShortCapacity) {
+      string_detail::Copy(rep_.local.data, str.Data(), size);
+      this->SetInlineSize(size);
+      return;
+    }
+    auto capacity = this->CheckedCapacity(size);
+    auto *data = this->AllocateBuffer(capacity);
+    std::memcpy(data, str.Data(), size);
+    data[size] = '\0';
+    rep_.heap = Heap{data, size, EncodeCapacity(capacity)};
+  }
+
+  // Moves the characters to a heap buffer of at least 'capacity'
+  // characters, which holds at least all of them.
+  void Reallocate(size_type capacity) {
+    auto *data = this->AllocateBuffer(capacity);
+    auto size = this->Size();
+    string_detail::Copy(data, this->Data(), size + 1);
+    this->ReleaseBuffer();
+    rep_.heap = Heap{data, size, EncodeCapacity(capacity)};
+  }
+
+  // The characters of 'str' are copied before the old buffer is freed, so
+  // it may point into it.
+  void AppendGrow(StringView str) {
+    auto size = this->Size();
+    auto capacity = this->NextCapacity(this->CheckedSize(size, str.Size()));
+    auto *data = this->AllocateBuffer(capacity);
+    string_detail::Copy(data, this->Data(), size);
+    string_detail::Copy(data + size, str.Data(), str.Size());
+    data[size + str.Size()] = '\0';
+    this->ReleaseBuffer();
+    rep_.heap = Heap{data, size + str.Size(), EncodeCapacity(capacity)};
+  }
+
+  // Frees a heap buffer without touching the representation.
+  void ReleaseBuffer() noexcept {
+    if (!this->IsInline()) {
+      AllocTraits::deallocate(alloc_, rep_.heap.data, DecodeCapacity(rep_.heap.capacity) + 1);
+    }
+  }
+
+  void Deallocate() noexcept {
+    this->ReleaseBuffer();
+    rep_ = Rep();
+  }
+
+private:
+  // Starts as an empty inline string: all zeros but the spare capacity.
+  union Rep {
+    constexpr Rep() noexcept : local{{}, static_cast<unsigned char>(kShortCapacity)} {}
+
+    Heap heap;
+    Inline local;
+  };
+
+  Rep rep_;
+  [[no_unique_address]] Alloc alloc_;
+};
+
+using String = BasicString<>;
+
+static_assert(sizeof(String) == 3 * sizeof(void*));
+
+template <typename Alloc, typename Growth>
+struct IsTriviallyRelocatable<BasicString<Alloc, Growth>>
+    : std::bool_constant<std::is_empty_v<Alloc> || IsTriviallyRelocatableValue<Alloc>> {};
+
+template <typename Alloc, typename Growth>
+struct DefaultHash<BasicString<Alloc, Growth>> : StringHash {};
+
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "Hash.hpp"
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tystl {
+
+namespace string_detail {
+
+using Traits = std::char_traits<char>;
+
+// Like memcpy and memmove, but fine with a null pointer when 'count' is 0.
+inline void Copy(char *to, const char *from, std::size_t count) noexcept {
+  if (count != 0) {
+    std::memcpy(to, from, count);
+  }
+}
+
+inline void Move(char *to, const char *from, std::size_t count) noexcept {
+  if (count != 0) {
+    std::memmove(to, from, count);
+  }
+}
+
+// The first 'needle' in 'haystack', or npos. 'needle' has at least two
+// characters and fits in 'haystack'.
+//
+// Candidates are found 16 positions at a time by comparing both the first
+// and the last character of the needle, which rules out most positions
+// that only share the first character; only the rest are compared in
+// full.
+inline std::size_t Search(const char *haystack, std::size_t size, const char *needle, std::size_t count) noexcept {
+  const std::size_t last = size - count;
+  std::size_t pos = 0;
+#if defined(__SSE2__)
+  const auto first_char = _mm_set1_epi8(needle[0]);
+  const auto last_char = _mm_set1_epi8(needle[count - 1]);
+  for (; pos + 16 <= last + 1; pos += 16) {
+    auto front = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + pos));
+    auto back = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + pos + count - 1));
+    auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+      _mm_and_si128(_mm_cmpeq_epi8(front, first_char), _mm_cmpeq_epi8(back, last_char))));
+    while (mask != 0) {
+      auto candidate = pos + static_cast<std::size_t>(std::countr_zero(mask));
+      if (std::memcmp(haystack + candidate + 1, needle + 1, count - 2) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  while (pos <= last) {
+    const auto *found = static_cast<const char*>(std::memchr(haystack + pos, needle[0], last + 1 - pos));
+    if (found == nullptr) {
+      break;
+    }
+    pos = static_cast<std::size_t>(found - haystack);
+    if (std::memcmp(found + 1, needle + 1, count - 1) == 0) {
+      return pos;
+    }
+    pos++;
+  }
+  return std::string_view::npos;
+}
+
+} // namespace string_detail
+
+// A non-owning view of a run of characters, std::string_view with the
+// library's spellings. 'Find' scans with SSE2 where it is available, and
+// 'Hash' is the hash the tystl hash containers use for every string type,
+// so any of them can look up a key of another.
+//
+// The view must not outlive the characters it was made from.
+class StringView {
+public:
+  using value_type             = char;
+  using size_type              = std::size_t;
+  using difference_type        = std::ptrdiff_t;
+  using pointer                = char*;
+  using const_pointer          = const char*;
+  using reference              = char&;
+  using const_reference        = const char&;
+  using iterator               = const char*;
+  using const_iterator         = const char*;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type npos = std::string_view::npos;
+
+public:
+  constexpr StringView() noexcept = default;
+
+  constexpr StringView(const char *str) noexcept : data_(str), size_(string_detail::Traits::length(str)) {}
+
+  constexpr StringView(const char *data, size_type size) noexcept : data_(data), size_(size) {}
+
+  constexpr StringView(std::string_view str) noexcept : data_(str.data()), size_(str.size()) {}
+
+  StringView(const std::string &str) noexcept : data_(str.data()), size_(str.size()) {}
+
+  StringView(std::nullptr_t) = delete;
+
+  constexpr operator std::string_view() const noexcept {
+    return std::string_view(data_, size_);
+  }
+
+public:
+  [[nodiscard]]
+  constexpr const char* Data() const noexcept {
+    return data_;
+  }
+
+  [[nodiscard]]
+  constexpr size_type Size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]]
+  constexpr bool Empty() const noexcept {
+    return size_ == 0;
+  }
+
+  [[nodiscard]]
+  constexpr const char& operator[](size_type pos) const noexcept {
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  constexpr const char& At(size_type pos) const {
+    if (size_ <= pos) {
+      throw std::out_of_range("StringView::At");
+    }
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  constexpr const char& Front() const noexcept {
+    return data_[0];
+  }
+
+  [[nodiscard]]
+  constexpr const char& Back() const noexcept {
+    return data_[size_ - 1];
+  }
+
+  constexpr void RemovePrefix(size_type count) noexcept {
+    data_ += count;
+    size_ -= count;
+  }
+
+  constexpr void RemoveSuffix(size_type count) noexcept {
+    size_ -= count;
+  }
+
+  // At most 'count' characters from 'pos'. Throws std::out_of_range if
+  // 'pos' is past the end.
+  [[nodiscard]]
+  constexpr StringView Substr(size_type pos, size_type count = npos) const {
+    if (pos > size_) {
+      throw std::out_of_range("StringView::Substr");
+    }
+    return StringView(data_ + pos, std::min(count, size_ - pos));
+  }
+
+  [[nodiscard]]
+  constexpr size_type Find(char ch, size_type pos = 0) const noexcept {
+    if consteval {
+      return std::string_view(*this).find(ch, pos);
+    } else {
+      if (pos >= size_) {
+        return npos;
+      }
+      const auto *found = static_cast<const char*>(std::memchr(data_ + pos, ch, size_ - pos));
+      return found == nullptr ? npos : static_cast<size_type>(found - data_);
+    }
+  }
+
+  [[nodiscard]]
+  constexpr size_type Find(StringView str, size_type pos = 0) const noexcept {
+    if consteval {
+      return std::string_view(*this).find(str, pos);
+    } else {
+      if (pos > size_ || str.size_ > size_ - pos) {
+        return npos;
+      }
+      if (str.size_ <= 1) {
+        return str.size_ == 0 ? pos : this->Find(str.data_[0], pos);
+      }
+      auto found = string_detail::Search(data_ + pos, size_ - pos, str.data_, str.size_);
+      return found == npos ? npos : found + pos;
+    }
+  }
+
+  [[nodiscard]]
+  constexpr size_type RFind(char ch, size_type pos = npos) const noexcept {
+    return std::string_view(*this).rfind(ch, pos);
+  }
+
+  [[nodiscard]]
+  constexpr size_type RFind(StringView str, size_type pos = npos) const noexcept {
+    return std::string_view(*this).rfind(str, pos);
+  }
+
+  [[nodiscard]]
+  constexpr bool Contains(char ch) const noexcept {
+    return this->Find(ch) != npos;
+  }
+
+  [[nodiscard]]
+  constexpr bool Contains(StringView str) const noexcept {
+    return this->Find(str) != npos;
+  }
+
+  [[nodiscard]]
+  constexpr bool StartsWith(StringView prefix) const noexcept {
+    return size_ >= prefix.size_ && string_detail::Traits::compare(data_, prefix.data_, prefix.size_) == 0;
+  }
+
+  [[nodiscard]]
+  constexpr bool EndsWith(StringView suffix) const noexcept {
+    return size_ >= suffix.size_ &&
+           string_detail::Traits::compare(data_ + size_ - suffix.size_, suffix.data_, suffix.size_) == 0;
+  }
+
+  // Negative, zero or positive as this view orders before, with or after
+  // 'other', comparing characters as unsigned.
+  [[nodiscard]]
+  constexpr int Compare(StringView other) const noexcept {
+    auto result = string_detail::Traits::compare(data_, other.data_, std::min(size_, other.size_));
+    if (result != 0) {
+      return result;
+    }
+    return size_ < other.size_ ? -1 : size_ > other.size_ ? 1 : 0;
+  }
+
+  [[nodiscard]]
+  std::uint64_t Hash() const noexcept {
+    return HashBytes(data_, size_);
+  }
+
+  [[nodiscard]]
+  friend constexpr bool operator==(StringView left, StringView right) noexcept {
+    return left.size_ == right.size_ && string_detail::Traits::compare(left.data_, right.data_, left.size_) == 0;
+  }
+
+  [[nodiscard]]
+  friend constexpr std::strong_ordering operator<=>(StringView left, StringView right) noexcept {
+    return left.Compare(right) <=> 0;
+  }
+
+public:
+  constexpr const_iterator begin() const noexcept {
+    return data_;
+  }
+
+  constexpr const_iterator end() const noexcept {
+    return data_ + size_;
+  }
+
+  constexpr const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  constexpr const_iterator cend() const noexcept {
+    return end();
+  }
+
+  constexpr const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  constexpr const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  constexpr const char* data() const noexcept {
+    return data_;
+  }
+
+  constexpr size_type size() const noexcept {
+    return size_;
+  }
+
+  constexpr bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+private:
+  const char *data_ = nullptr;
+  size_type size_ = 0;
+};
+
+template <>
+struct DefaultHash<StringView> : StringHash {};
+
+}
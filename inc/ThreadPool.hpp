@@ -0,0 +1,661 @@
+#pragma once
+
+#include "Backoff.hpp"
+#include "BinaryHeap.hpp"
+#include "Optional.hpp"
+#include "Utility.hpp"
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tystl {
+
+class ThreadPool;
+
+namespace thread_pool_detail {
+
+// A unit of work. 'run' must not throw; a heap allocated task frees itself
+// in it.
+struct Task {
+  void (*run)(Task *task) noexcept;
+};
+
+// Chase and Lev's work stealing deque, with the memory orders of Lê et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models". The owner
+// pushes and pops at the bottom; other threads steal from the top, so they
+// take the oldest, usually largest, piece of work.
+class WorkStealingDeque {
+public:
+  explicit WorkStealingDeque(std::size_t capacity = 1024)
+      : buffer_(new Buffer(std::bit_ceil(capacity))) {}
+
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+  WorkStealingDeque& operator=(const WorkStealingDeque &) = delete;
+
+  ~WorkStealingDeque() {
+    delete buffer_.load(std::memory_order_relaxed);
+  }
+
+public:
+  // Owner only.
+  auto Push(Task *task) -> void {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    auto *buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<std::int64_t>(buffer->mask)) {
+      buffer = this->Grow(buffer, top, bottom);
+    }
+    buffer->Put(bottom, task);
+    bottom_.store(bottom + 1, std::memory_order_release);
+  }
+
+  // Owner only. Returns the newest task, or null if the deque is empty.
+  auto Pop() noexcept -> Task* {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    auto *buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_seq_cst);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    auto *task = buffer->Get(bottom);
+    if (top == bottom) {
+      // The last task, which a thief may be taking at the same time.
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        task = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  // Any thread. Returns the oldest task, or null if the deque is empty or
+  // another thread got there first.
+  auto Steal() noexcept -> Task* {
+    auto top = top_.load(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_seq_cst);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    auto *task = buffer_.load(std::memory_order_acquire)->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return task;
+  }
+
+  // Approximate unless called by the owner.
+  auto Empty() const noexcept -> bool {
+    return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Buffer {
+    explicit Buffer(std::size_t capacity)
+        : mask(capacity - 1), slots(std::make_unique<std::atomic<Task*>[]>(capacity)) {}
+
+    auto Get(std::int64_t index) const noexcept -> Task* {
+      return slots[static_cast<std::size_t>(index) & mask].load(std::memory_order_relaxed);
+    }
+
+    auto Put(std::int64_t index, Task *task) noexcept -> void {
+      slots[static_cast<std::size_t>(index) & mask].store(task, std::memory_order_relaxed);
+    }
+
+    std::size_t mask;
+    std::unique_ptr<std::atomic<Task*>[]> slots;
+  };
+
+  // Thieves may still be reading the old buffer, so it is kept until the
+  // deque goes away.
+  auto Grow(Buffer *buffer, std::int64_t top, std::int64_t bottom) -> Buffer* {
+    auto grown = std::make_unique<Buffer>(2 * (buffer->mask + 1));
+    for (auto i = top; i < bottom; i++) {
+      grown->Put(i, buffer->Get(i));
+    }
+    retired_.emplace_back(buffer);
+    buffer_.store(grown.get(), std::memory_order_release);
+    return grown.release();
+  }
+
+private:
+  alignas(kCacheLineSize) std::atomic<std::int64_t> top_{0};
+  alignas(kCacheLineSize) std::atomic<std::int64_t> bottom_{0};
+  std::atomic<Buffer*> buffer_;
+  std::vector<std::unique_ptr<Buffer>> retired_;
+};
+
+// Stands in for the result of a task that returns void.
+struct Unit {};
+
+// What a Future shares with its task: the result or the exception, and a
+// reference count held by both.
+template <typename R>
+struct FutureState : Task {
+  using Value = std::conditional_t<std::is_void_v<R>, Unit, R>;
+
+  auto Release() noexcept -> void {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      destroy(this);
+    }
+  }
+
+  ThreadPool *pool = nullptr;
+  void (*destroy)(FutureState *state) noexcept = nullptr;
+  std::atomic<std::uint32_t> refs{2};
+  std::atomic<bool> done{false};
+  Optional<Value> value;
+  std::exception_ptr error;
+};
+
+template <typename R, typename F>
+struct SubmitTask : FutureState<R> {
+  explicit SubmitTask(ThreadPool *owner, F &&init) {
+    this->run = &SubmitTask::Run;
+    this->destroy = &SubmitTask::Destroy;
+    this->pool = owner;
+    func.Emplace(tystl::Forward<F>(init));
+  }
+
+  static auto Run(Task *task) noexcept -> void {
+    auto *self = static_cast<SubmitTask*>(task);
+    try {
+      if constexpr (std::is_void_v<R>) {
+        std::invoke(tystl::Move(*self->func));
+        self->value.Emplace();
+      } else {
+        self->value.Emplace(std::invoke(tystl::Move(*self->func)));
+      }
+    } catch (...) {
+      self->error = std::current_exception();
+    }
+    // Whatever the function captured goes now, not with the future.
+    self->func.Reset();
+    self->done.store(true, std::memory_order_release);
+    self->done.notify_all();
+    self->Release();
+  }
+
+  static auto Destroy(FutureState<R> *state) noexcept -> void {
+    delete static_cast<SubmitTask*>(state);
+  }
+
+  Optional<std::decay_t<F>> func;
+};
+
+// The second half of a 'Join', which lives on the joining thread's stack.
+template <typename F>
+struct JoinTask : Task {
+  explicit JoinTask(F &init) : func(init) {
+    this->run = &JoinTask::Run;
+  }
+
+  static auto Run(Task *task) noexcept -> void {
+    auto *self = static_cast<JoinTask*>(task);
+    try {
+      std::invoke(self->func);
+    } catch (...) {
+      self->error = std::current_exception();
+    }
+    // The joiner may return, and free this task, as soon as it sees 'done'.
+    self->done.store(true, std::memory_order_release);
+  }
+
+  F &func;
+  std::atomic<bool> done{false};
+  std::exception_ptr error;
+};
+
+// The pool and worker index of the calling thread, if it is a worker.
+struct CurrentWorker {
+  const ThreadPool *pool = nullptr;
+  std::size_t index = 0;
+};
+
+// Orders injected tasks by descending priority, then by submission.
+struct Injected {
+  int priority;
+  std::uint64_t sequence;
+  Task *task;
+};
+
+struct InjectedOrder {
+  auto operator()(const Injected &left, const Injected &right) const noexcept -> bool {
+    if (left.priority != right.priority) {
+      return left.priority > right.priority;
+    }
+    return left.sequence < right.sequence;
+  }
+};
+
+} // namespace thread_pool_detail
+
+// The result of a task passed to 'ThreadPool::Submit'. Dropping a future
+// does not wait for or cancel its task.
+template <typename R>
+class Future {
+  friend class ThreadPool;
+
+  using State = thread_pool_detail::FutureState<R>;
+
+public:
+  Future() noexcept = default;
+
+  Future(Future &&other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+
+  Future& operator=(Future &&other) noexcept {
+    Future(tystl::Move(other)).Swap(*this);
+    return *this;
+  }
+
+  ~Future() {
+    if (state_ != nullptr) {
+      state_->Release();
+    }
+  }
+
+public:
+  auto Swap(Future &other) noexcept -> void {
+    std::swap(state_, other.state_);
+  }
+
+  auto Valid() const noexcept -> bool { return state_ != nullptr; }
+
+  auto Ready() const noexcept -> bool {
+    return state_->done.load(std::memory_order_acquire);
+  }
+
+  // On a worker of the pool, runs other tasks while waiting.
+  auto Wait() const -> void;
+
+  // Waits, then returns the result or rethrows what the task threw. Call it
+  // at most once.
+  auto Get() -> R {
+    this->Wait();
+    if (state_->error) {
+      std::rethrow_exception(state_->error);
+    }
+    if constexpr (!std::is_void_v<R>) {
+      return tystl::Move(*state_->value);
+    }
+  }
+
+private:
+  explicit Future(State *state) noexcept : state_(state) {}
+
+private:
+  State *state_ = nullptr;
+};
+
+// A fixed set of worker threads, each with its own work stealing deque.
+// Work submitted from a worker goes to the bottom of its deque and is
+// taken back LIFO, which keeps a fork-join computation depth first and in
+// cache; idle workers steal from the top of other deques. Work submitted
+// from other threads, or with a priority, goes to a shared injection queue
+// that hands out the highest priority first.
+//
+// Idle workers spin briefly, then sleep until new work arrives. The
+// destructor lets the workers finish everything already queued.
+class ThreadPool {
+  using Task = thread_pool_detail::Task;
+
+public:
+  // 0 threads means one per hardware thread.
+  explicit ThreadPool(std::size_t threads = 0)
+      : worker_count_(threads != 0 ? threads : DefaultThreadCount()),
+        workers_(std::make_unique<Worker[]>(worker_count_)) {
+    threads_.reserve(worker_count_);
+    for (std::size_t i = 0; i < worker_count_; i++) {
+      threads_.emplace_back([this, i] { this->WorkerLoop(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool& operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    stop_.store(true, std::memory_order_release);
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+public:
+  auto ThreadCount() const noexcept -> std::size_t { return worker_count_; }
+
+  // True on the threads of this pool.
+  auto OnWorker() const noexcept -> bool { return current_.pool == this; }
+
+  // Runs 'func' on the pool. On a worker it goes to that worker's deque,
+  // anywhere else to the injection queue with priority 0.
+  template <typename F>
+    requires std::invocable<std::decay_t<F>&&> && (!std::is_reference_v<std::invoke_result_t<std::decay_t<F>&&>>)
+  auto Submit(F &&func) -> Future<std::invoke_result_t<std::decay_t<F>&&>> {
+    using R = std::invoke_result_t<std::decay_t<F>&&>;
+    auto *task = new thread_pool_detail::SubmitTask<R, F>(this, tystl::Forward<F>(func));
+    if (this->OnWorker()) {
+      workers_[current_.index].deque.Push(task);
+      this->Wake();
+    } else {
+      this->Inject(0, task);
+    }
+    return Future<R>(task);
+  }
+
+  // Runs 'func' from the injection queue, before any queued task of lower
+  // priority. Tasks already in a worker's deque are not overtaken.
+  template <typename F>
+    requires std::invocable<std::decay_t<F>&&> && (!std::is_reference_v<std::invoke_result_t<std::decay_t<F>&&>>)
+  auto Submit(int priority, F &&func) -> Future<std::invoke_result_t<std::decay_t<F>&&>> {
+    using R = std::invoke_result_t<std::decay_t<F>&&>;
+    auto *task = new thread_pool_detail::SubmitTask<R, F>(this, tystl::Forward<F>(func));
+    this->Inject(priority, task);
+    return Future<R>(task);
+  }
+
+  // Runs 'left' and 'right', possibly in parallel, and returns when both
+  // are done. 'right' is offered to other workers while this thread runs
+  // 'left'; if nobody took it, this thread runs it too. If either throws,
+  // the exception is rethrown once both are done, 'left's first.
+  template <std::invocable Left, std::invocable Right>
+  auto Join(Left &&left, Right &&right) -> void {
+    if (!this->OnWorker()) {
+      this->Submit([&] { this->Join(left, right); }).Get();
+      return;
+    }
+    auto index = current_.index;
+    auto &deque = workers_[index].deque;
+    thread_pool_detail::JoinTask<Right> job(right);
+    deque.Push(&job);
+    this->Wake();
+
+    std::exception_ptr error;
+    try {
+      std::invoke(left);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    // Tasks 'left' submitted without waiting may sit above 'job'.
+    bool inline_run = false;
+    while (auto *task = deque.Pop()) {
+      if (task == &job) {
+        inline_run = true;
+        break;
+      }
+      task->run(task);
+    }
+    if (inline_run) {
+      job.run(&job);
+    } else {
+      // Stolen. Help the thieves, but leave the injection queue alone so
+      // this join is not held up by unrelated work.
+      Backoff backoff;
+      while (!job.done.load(std::memory_order_acquire)) {
+        if (auto *task = this->Steal(index)) {
+          task->run(task);
+          backoff.Reset();
+        } else {
+          backoff.Pause();
+        }
+      }
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    if (job.error) {
+      std::rethrow_exception(job.error);
+    }
+  }
+
+  // Calls 'body(lo, hi)' on disjoint subranges covering [first, last),
+  // splitting in halves down to at most 'grain' indices each. Smaller
+  // grains balance better and cost more scheduling.
+  template <typename Body>
+    requires std::invocable<Body&, std::size_t, std::size_t>
+  auto ParallelFor(std::size_t first, std::size_t last, std::size_t grain, Body &&body) -> void {
+    if (first >= last) {
+      return;
+    }
+    this->SplitFor(first, last, grain != 0 ? grain : 1, body);
+  }
+
+  // As above, with a grain that makes about eight pieces per worker.
+  template <typename Body>
+    requires std::invocable<Body&, std::size_t, std::size_t>
+  auto ParallelFor(std::size_t first, std::size_t last, Body &&body) -> void {
+    this->ParallelFor(first, last, this->DefaultGrain(first, last), body);
+  }
+
+  // Folds [first, last): each piece of at most 'grain' indices becomes
+  // 'reduce(lo, hi, identity)', and neighbouring results are merged with
+  // 'combine(left, right)' in index order, so 'combine' need only be
+  // associative.
+  template <typename T, typename Reduce, typename Combine>
+    requires std::copy_constructible<T> && std::is_invocable_r_v<T, Reduce&, std::size_t, std::size_t, T> &&
+             std::is_invocable_r_v<T, Combine&, T, T>
+  auto ParallelReduce(std::size_t first, std::size_t last, std::size_t grain, T identity, Reduce &&reduce,
+                      Combine &&combine) -> T {
+    if (first >= last) {
+      return identity;
+    }
+    return this->SplitReduce(first, last, grain != 0 ? grain : 1, identity, reduce, combine);
+  }
+
+  template <typename T, typename Reduce, typename Combine>
+    requires std::copy_constructible<T> && std::is_invocable_r_v<T, Reduce&, std::size_t, std::size_t, T> &&
+             std::is_invocable_r_v<T, Combine&, T, T>
+  auto ParallelReduce(std::size_t first, std::size_t last, T identity, Reduce &&reduce, Combine &&combine) -> T {
+    return this->ParallelReduce(first, last, this->DefaultGrain(first, last), tystl::Move(identity), reduce,
+                                combine);
+  }
+
+private:
+  template <typename R>
+  friend class Future;
+
+  struct alignas(kCacheLineSize) Worker {
+    thread_pool_detail::WorkStealingDeque deque;
+    // State of the xorshift generator that picks steal victims.
+    std::uint64_t random = 0;
+  };
+
+  // Failed searches before an idle worker goes to sleep.
+  static constexpr std::size_t kSpinAttempts = 64;
+
+  static auto DefaultThreadCount() noexcept -> std::size_t {
+    auto threads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return threads != 0 ? threads : 1;
+  }
+
+  auto DefaultGrain(std::size_t first, std::size_t last) const noexcept -> std::size_t {
+    auto grain = (last - first) / (8 * worker_count_);
+    return grain != 0 ? grain : 1;
+  }
+
+  template <typename Body>
+  auto SplitFor(std::size_t first, std::size_t last, std::size_t grain, Body &body) -> void {
+    if (last - first <= grain) {
+      std::invoke(body, first, last);
+      return;
+    }
+    auto middle = first + (last - first) / 2;
+    this->Join([&] { this->SplitFor(first, middle, grain, body); },
+               [&] { this->SplitFor(middle, last, grain, body); });
+  }
+
+  template <typename T, typename Reduce, typename Combine>
+  auto SplitReduce(std::size_t first, std::size_t last, std::size_t grain, const T &identity, Reduce &reduce,
+                   Combine &combine) -> T {
+    if (last - first <= grain) {
+      return std::invoke(reduce, first, last, T(identity));
+    }
+    auto middle = first + (last - first) / 2;
+    Optional<T> left;
+    Optional<T> right;
+    this->Join([&] { left.Emplace(this->SplitReduce(first, middle, grain, identity, reduce, combine)); },
+               [&] { right.Emplace(this->SplitReduce(middle, last, grain, identity, reduce, combine)); });
+    return std::invoke(combine, tystl::Move(*left), tystl::Move(*right));
+  }
+
+  auto Inject(int priority, Task *task) -> void {
+    {
+      std::lock_guard lock(injected_mutex_);
+      injected_.Push({priority, next_sequence_++, task});
+      injected_size_.store(injected_.Size(), std::memory_order_relaxed);
+    }
+    this->Wake();
+  }
+
+  auto TakeInjected() -> Task* {
+    if (injected_size_.load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+    }
+    std::lock_guard lock(injected_mutex_);
+    if (injected_.Empty()) {
+      return nullptr;
+    }
+    auto *task = injected_.Top().task;
+    injected_.Pop();
+    injected_size_.store(injected_.Size(), std::memory_order_relaxed);
+    return task;
+  }
+
+  // Tries every other worker once, starting at a random one.
+  auto Steal(std::size_t index) noexcept -> Task* {
+    auto &random = workers_[index].random;
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    auto start = static_cast<std::size_t>(random % worker_count_);
+    for (std::size_t i = 0; i < worker_count_; i++) {
+      auto victim = (start + i) % worker_count_;
+      if (victim == index) {
+        continue;
+      }
+      if (auto *task = workers_[victim].deque.Steal()) {
+        return task;
+      }
+    }
+    return nullptr;
+  }
+
+  auto FindTask(std::size_t index) -> Task* {
+    if (auto *task = workers_[index].deque.Pop()) {
+      return task;
+    }
+    if (auto *task = this->TakeInjected()) {
+      return task;
+    }
+    return this->Steal(index);
+  }
+
+  // Called after queueing work. A sleeper either sees the work in its last
+  // search or is woken here: it announces itself before searching, and the
+  // fence orders the queueing before the check.
+  auto Wake() noexcept -> void {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) != 0) {
+      epoch_.fetch_add(1, std::memory_order_release);
+      epoch_.notify_one();
+    }
+  }
+
+  auto WorkerLoop(std::size_t index) -> void {
+    current_ = {this, index};
+    workers_[index].random = 0x9E3779B97F4A7C15ULL * (index + 1);
+    Backoff backoff;
+    std::size_t misses = 0;
+    while (true) {
+      if (auto *task = this->FindTask(index)) {
+        task->run(task);
+        backoff.Reset();
+        misses = 0;
+        continue;
+      }
+      if (stop_.load(std::memory_order_acquire)) {
+        break;
+      }
+      if (misses++ < kSpinAttempts) {
+        backoff.Pause();
+        continue;
+      }
+
+      // Pairs with the fence in 'Wake': the search below runs relaxed loads,
+      // which the seq_cst increment alone does not keep after it.
+      sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto epoch = epoch_.load(std::memory_order_acquire);
+      auto *task = this->FindTask(index);
+      if (task == nullptr && !stop_.load(std::memory_order_acquire)) {
+        epoch_.wait(epoch, std::memory_order_acquire);
+      }
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      if (task != nullptr) {
+        task->run(task);
+      }
+      backoff.Reset();
+      misses = 0;
+    }
+    current_ = thread_pool_detail::CurrentWorker{};
+  }
+
+  // Runs other tasks until 'done' is set if called on a worker, otherwise
+  // blocks.
+  auto WaitFor(const std::atomic<bool> &done) -> void {
+    if (!this->OnWorker()) {
+      done.wait(false, std::memory_order_acquire);
+      return;
+    }
+    Backoff backoff;
+    while (!done.load(std::memory_order_acquire)) {
+      if (auto *task = this->FindTask(current_.index)) {
+        task->run(task);
+        backoff.Reset();
+      } else {
+        backoff.Pause();
+      }
+    }
+  }
+
+private:
+  static inline thread_local thread_pool_detail::CurrentWorker current_{};
+
+  std::size_t worker_count_;
+  std::unique_ptr<Worker[]> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex injected_mutex_;
+  BinaryHeap<thread_pool_detail::Injected, thread_pool_detail::InjectedOrder> injected_;
+  std::uint64_t next_sequence_ = 0;
+  std::atomic<std::size_t> injected_size_{0};
+
+  alignas(kCacheLineSize) std::atomic<std::uint32_t> sleepers_{0};
+  alignas(kCacheLineSize) std::atomic<std::uint32_t> epoch_{0};
+  std::atomic<bool> stop_{false};
+};
+
+template <typename R>
+auto Future<R>::Wait() const -> void {
+  if (!this->Ready()) {
+    state_->pool->WaitFor(state_->done);
+  }
+}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include <utility>
 
 namespace tystl {
 
@@ -11,12 +12,12 @@ struct RemoveReference {
 
 template <typename T>
 struct RemoveReference<T&> {
-  using Type = T&;
+  using Type = T;
 };
 
 template <typename T>
 struct RemoveReference<T&&> {
-  using Type = T&&;
+  using Type = T;
 };
 
 template <typename T>
@@ -37,4 +38,21 @@ inline constexpr bool IsLValueReferenceValue<T&> = true;
 template <typename T, typename ...Args>
 inline constexpr bool IsConstructibleValue = std::is_constructible_v<T, Args...>;
 
+// Whether moving a 'T' to new storage and destroying the source can be done
+// by copying its bytes, so containers may grow and erase with memcpy and
+// memmove. True for trivially copyable types. Types that own resources but
+// never point into themselves, such as UniquePtr or SharedPtr, opt in by
+// specializing.
+template <typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableValue = IsTriviallyRelocatable<std::remove_cv_t<T>>::value;
+
+// A pair is relocatable when both members are, even though its assignment
+// operators keep it from being trivially copyable.
+template <typename T1, typename T2>
+struct IsTriviallyRelocatable<std::pair<T1, T2>>
+    : std::bool_constant<IsTriviallyRelocatableValue<T1> && IsTriviallyRelocatableValue<T2>> {};
+
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Instrument.hpp"
 #include "Utility.hpp"
 #include <type_traits>
 #include <utility>
@@ -119,11 +120,18 @@ private:
   Deleter deleter_;
 };
 
+// Only the deleter could point into the UniquePtr itself.
+template <typename T, typename Deleter>
+  requires std::is_invocable_v<Deleter, T*>
+struct IsTriviallyRelocatable<UniquePtr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
 template <typename T, typename ...Args>
   requires std::is_constructible_v<T, Args...>
 [[nodiscard]]
 constexpr UniquePtr<T> MakeUnique(Args &&...args) {
-  return UniquePtr<T>(new T(std::forward<Args>(args)...));
+  auto *ptr = new T(std::forward<Args>(args)...);
+  instrument::CountAllocation<T>(sizeof(T));
+  return UniquePtr<T>(ptr);
 }
 
 }
@@ -7,6 +7,10 @@
 
 namespace tystl {
 
+// Assumed size of a cache line, used to keep data written by different
+// threads apart.
+inline constexpr std::size_t kCacheLineSize = 64;
+
 template <typename T>
 [[nodiscard]]
 constexpr RemoveReferenceType<T>&& Move(T&& value) noexcept {
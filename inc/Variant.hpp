@@ -0,0 +1,600 @@
+#pragma once
+
+#include "Concept.hpp"
+#include "TypeTraits.hpp"
+#include "Utility.hpp"
+#include <array>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace tystl {
+
+// An alternative that holds nothing, to make a Variant default
+// constructible or to stand for "no value".
+struct Monostate {
+  friend constexpr auto operator==(Monostate, Monostate) noexcept -> bool = default;
+
+  friend constexpr auto operator<=>(Monostate, Monostate) noexcept -> std::strong_ordering = default;
+};
+
+// The index of a Variant that lost its value to an exception.
+inline constexpr std::size_t kVariantNpos = static_cast<std::size_t>(-1);
+
+template <typename... Ts>
+  requires (sizeof...(Ts) > 0) && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts>))
+class Variant;
+
+namespace variant_detail {
+
+// The smallest unsigned type that counts 'N' alternatives and still has a
+// value left over for the valueless state.
+template <std::size_t N>
+using IndexType = std::conditional_t<(N < std::numeric_limits<std::uint8_t>::max()), std::uint8_t,
+                  std::conditional_t<(N < std::numeric_limits<std::uint16_t>::max()), std::uint16_t,
+                                     std::uint32_t>>;
+
+template <std::size_t I, typename T, typename... Rest>
+struct TypeAt {
+  using Type = typename TypeAt<I - 1, Rest...>::Type;
+};
+
+template <typename T, typename... Rest>
+struct TypeAt<0, T, Rest...> {
+  using Type = T;
+};
+
+// The index of the first 'T' among 'Ts', or kVariantNpos.
+template <typename T, typename... Ts>
+inline constexpr std::size_t kIndexOf = [] {
+  constexpr bool same[] = {IsSameValue<T, Ts>...};
+  for (std::size_t i = 0; i < sizeof...(Ts); i++) {
+    if (same[i]) {
+      return i;
+    }
+  }
+  return kVariantNpos;
+}();
+
+template <typename T, typename... Ts>
+inline constexpr std::size_t kCountOf = (std::size_t{IsSameValue<T, Ts>} + ...);
+
+// Storage for one of 'Ts', trivially destructible and copyable when all of
+// them are.
+template <typename... Ts>
+union Union {};
+
+template <typename T, typename... Rest>
+union Union<T, Rest...> {
+  constexpr Union() noexcept : none() {}
+
+  template <typename... Args>
+  constexpr explicit Union(std::in_place_index_t<0>, Args &&...args) : head(tystl::Forward<Args>(args)...) {}
+
+  template <std::size_t I, typename... Args>
+  constexpr explicit Union(std::in_place_index_t<I>, Args &&...args)
+      : tail(std::in_place_index<I - 1>, tystl::Forward<Args>(args)...) {}
+
+  constexpr Union(const Union &) = default;
+
+  constexpr Union(Union &&) = default;
+
+  constexpr auto operator=(const Union &) -> Union & = default;
+
+  constexpr auto operator=(Union &&) -> Union & = default;
+
+  constexpr ~Union() requires (std::is_trivially_destructible_v<T> && ... &&
+                               std::is_trivially_destructible_v<Rest>) = default;
+
+  constexpr ~Union() {}
+
+  struct None {};
+
+  None none;
+  T head;
+  Union<Rest...> tail;
+};
+
+// Steps eight members at a time, which keeps the instantiations for wide
+// variants down.
+template <std::size_t I, typename U>
+constexpr auto GetAt(U &storage) noexcept -> auto & {
+  if constexpr (I >= 8) {
+    return GetAt<I - 8>(storage.tail.tail.tail.tail.tail.tail.tail.tail);
+  } else if constexpr (I >= 4) {
+    return GetAt<I - 4>(storage.tail.tail.tail.tail);
+  } else if constexpr (I == 0) {
+    return storage.head;
+  } else if constexpr (I == 1) {
+    return storage.tail.head;
+  } else if constexpr (I == 2) {
+    return storage.tail.tail.head;
+  } else {
+    return storage.tail.tail.tail.head;
+  }
+}
+
+// Calls 'func.template operator()<I>()' with the run time 'index' as 'I',
+// which must be below 'N'. Up to 64 alternatives this is a switch, which
+// the compiler turns into a jump table and whose cases it may inline;
+// beyond that it is a table of function pointers.
+template <std::size_t N, typename F>
+constexpr auto Dispatch(std::size_t index, F &&func) -> decltype(auto) {
+  using R = decltype(tystl::Forward<F>(func).template operator()<0>());
+
+#define TYSTL_VARIANT_CASE(I)                                                    \
+  case I:                                                                        \
+    if constexpr (I < N) {                                                       \
+      return static_cast<R>(tystl::Forward<F>(func).template operator()<I>());   \
+    }                                                                            \
+    [[fallthrough]];
+#define TYSTL_VARIANT_CASES_4(I)                                                 \
+  TYSTL_VARIANT_CASE(I) TYSTL_VARIANT_CASE(I + 1)                                \
+  TYSTL_VARIANT_CASE(I + 2) TYSTL_VARIANT_CASE(I + 3)
+#define TYSTL_VARIANT_CASES_16(I)                                                \
+  TYSTL_VARIANT_CASES_4(I) TYSTL_VARIANT_CASES_4(I + 4)                          \
+  TYSTL_VARIANT_CASES_4(I + 8) TYSTL_VARIANT_CASES_4(I + 12)
+
+  if constexpr (N <= 16) {
+    switch (index) {
+      TYSTL_VARIANT_CASES_16(0)
+      default:
+        break;
+    }
+    std::unreachable();
+  } else if constexpr (N <= 64) {
+    switch (index) {
+      TYSTL_VARIANT_CASES_16(0)
+      TYSTL_VARIANT_CASES_16(16)
+      TYSTL_VARIANT_CASES_16(32)
+      TYSTL_VARIANT_CASES_16(48)
+      default:
+        break;
+    }
+    std::unreachable();
+  } else {
+    constexpr auto table = []<std::size_t... Is>(std::index_sequence<Is...>) {
+      using Entry = R (*)(F &&);
+      return std::array<Entry, N>{+[](F &&f) -> R { return tystl::Forward<F>(f).template operator()<Is>(); }...};
+    }(std::make_index_sequence<N>());
+    return table[index](tystl::Forward<F>(func));
+  }
+
+#undef TYSTL_VARIANT_CASES_16
+#undef TYSTL_VARIANT_CASES_4
+#undef TYSTL_VARIANT_CASE
+}
+
+template <typename T>
+inline constexpr bool kIsVariant = false;
+
+template <typename... Ts>
+inline constexpr bool kIsVariant<Variant<Ts...>> = true;
+
+// The alternative 'I' of a variant with the value category of 'V'.
+template <std::size_t I, typename V>
+constexpr auto Forwarded(V &&variant) noexcept -> decltype(auto) {
+  auto &value = variant.template UncheckedGet<I>();
+  if constexpr (std::is_lvalue_reference_v<V>) {
+    return value;
+  } else {
+    return tystl::Move(value);
+  }
+}
+
+// The alternative indices of position 'Flat' in the row major grid of the
+// alternatives of 'Vs'.
+template <std::size_t Flat, typename... Vs>
+inline constexpr auto kUnflatten = [] {
+  constexpr std::size_t sizes[] = {std::remove_cvref_t<Vs>::kSize...};
+  std::array<std::size_t, sizeof...(Vs)> indices{};
+  auto rest = Flat;
+  for (std::size_t k = sizeof...(Vs); k-- > 0;) {
+    indices[k] = rest % sizes[k];
+    rest /= sizes[k];
+  }
+  return indices;
+}();
+
+// A Variant alternative may be chosen for a 'U' if it can be built from it
+// without a narrowing conversion, as for std::variant.
+template <typename T>
+using SingleArray = T[1];
+
+template <std::size_t I, typename T>
+struct Candidate {
+  template <typename U>
+    requires requires(U &&value) { SingleArray<T>{tystl::Forward<U>(value)}; }
+  auto operator()(T, U &&) const -> std::integral_constant<std::size_t, I>;
+};
+
+template <typename Indices, typename... Ts>
+struct Candidates;
+
+template <std::size_t... Is, typename... Ts>
+struct Candidates<std::index_sequence<Is...>, Ts...> : Candidate<Is, Ts>... {
+  using Candidate<Is, Ts>::operator()...;
+};
+
+template <typename U, typename... Ts>
+using Selected = decltype(Candidates<std::index_sequence_for<Ts...>, Ts...>()(std::declval<U>(), std::declval<U>()));
+
+} // namespace variant_detail
+
+// Holds a value of exactly one of 'Ts', inline. The index is the smallest
+// unsigned type that fits, one byte for fewer than 255 alternatives, and
+// the Variant is trivially copyable or destructible when every alternative
+// is. Accessing it never allocates or consults RTTI.
+//
+// If building a new value throws after the old one was destroyed, the
+// Variant is left valueless, as std::variant is. A Variant of trivially
+// copyable alternatives never is.
+template <typename... Ts>
+  requires (sizeof...(Ts) > 0) && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts>))
+class Variant {
+  using Discriminator = variant_detail::IndexType<sizeof...(Ts)>;
+
+  static constexpr Discriminator kValueless = std::numeric_limits<Discriminator>::max();
+
+  static constexpr bool kTriviallyDestructible = (... && std::is_trivially_destructible_v<Ts>);
+
+  static constexpr bool kTriviallyCopyable = kTriviallyDestructible &&
+    (... && (std::is_trivially_copy_constructible_v<Ts> && std::is_trivially_copy_assignable_v<Ts>));
+
+  static constexpr bool kTriviallyMovable = kTriviallyDestructible &&
+    (... && (std::is_trivially_move_constructible_v<Ts> && std::is_trivially_move_assignable_v<Ts>));
+
+  // A throwing Emplace builds the value aside first when moving it in is
+  // free, so such a Variant never loses its value and nothing checks for
+  // that.
+  static constexpr bool kNeverValueless = (... && std::is_trivially_copyable_v<Ts>);
+
+public:
+  static constexpr std::size_t kSize = sizeof...(Ts);
+
+  template <std::size_t I>
+    requires (I < kSize)
+  using Alternative = typename variant_detail::TypeAt<I, Ts...>::Type;
+
+  template <typename T>
+  static constexpr std::size_t kIndexOf = variant_detail::kIndexOf<T, Ts...>;
+
+  // 'T' is one of the alternatives, exactly once.
+  template <typename T>
+  static constexpr bool kUnique = variant_detail::kCountOf<T, Ts...> == 1;
+
+public:
+  constexpr Variant() noexcept(std::is_nothrow_default_constructible_v<Alternative<0>>)
+    requires std::is_default_constructible_v<Alternative<0>>
+      : storage_(std::in_place_index<0>), index_(0) {}
+
+  // Picks the alternative the way std::variant does: the one overload
+  // resolution prefers, ruling out narrowing conversions.
+  template <typename U, std::size_t I = variant_detail::Selected<U, Ts...>::value>
+    requires (!SameAs<std::remove_cvref_t<U>, Variant>) &&
+             (!variant_detail::kIsVariant<std::remove_cvref_t<U>>) &&
+             std::is_constructible_v<Alternative<I>, U>
+  constexpr Variant(U &&value) noexcept(std::is_nothrow_constructible_v<Alternative<I>, U>)
+      : storage_(std::in_place_index<I>, tystl::Forward<U>(value)), index_(I) {}
+
+  template <std::size_t I, typename... Args>
+    requires (I < kSize) && std::is_constructible_v<Alternative<I>, Args...>
+  constexpr explicit Variant(std::in_place_index_t<I>, Args &&...args)
+      : storage_(std::in_place_index<I>, tystl::Forward<Args>(args)...), index_(I) {}
+
+  template <typename T, typename... Args>
+    requires kUnique<T> && std::is_constructible_v<T, Args...>
+  constexpr explicit Variant(std::in_place_type_t<T>, Args &&...args)
+      : Variant(std::in_place_index<kIndexOf<T>>, tystl::Forward<Args>(args)...) {}
+
+  constexpr Variant(const Variant &) requires kTriviallyCopyable = default;
+
+  constexpr Variant(const Variant &other) noexcept((... && std::is_nothrow_copy_constructible_v<Ts>))
+    requires (!kTriviallyCopyable) && (... && std::is_copy_constructible_v<Ts>)
+  {
+    this->ConstructFrom(other);
+  }
+
+  constexpr Variant(Variant &&) requires kTriviallyMovable = default;
+
+  constexpr Variant(Variant &&other) noexcept((... && std::is_nothrow_move_constructible_v<Ts>))
+    requires (!kTriviallyMovable) && (... && std::is_move_constructible_v<Ts>)
+  {
+    this->ConstructFrom(tystl::Move(other));
+  }
+
+  constexpr auto operator=(const Variant &) -> Variant & requires kTriviallyCopyable = default;
+
+  constexpr auto operator=(const Variant &other) -> Variant &
+    requires (!kTriviallyCopyable) && (... && (std::is_copy_constructible_v<Ts> && std::is_copy_assignable_v<Ts>))
+  {
+    this->AssignFrom(other);
+    return *this;
+  }
+
+  constexpr auto operator=(Variant &&) -> Variant & requires kTriviallyMovable = default;
+
+  constexpr auto operator=(Variant &&other) noexcept((... && (std::is_nothrow_move_constructible_v<Ts> &&
+                                                             std::is_nothrow_move_assignable_v<Ts>))) -> Variant &
+    requires (!kTriviallyMovable) && (... && (std::is_move_constructible_v<Ts> && std::is_move_assignable_v<Ts>))
+  {
+    this->AssignFrom(tystl::Move(other));
+    return *this;
+  }
+
+  // Assigns to the held alternative if it is the one 'value' selects,
+  // otherwise replaces it.
+  template <typename U, std::size_t I = variant_detail::Selected<U, Ts...>::value>
+    requires (!SameAs<std::remove_cvref_t<U>, Variant>) &&
+             (!variant_detail::kIsVariant<std::remove_cvref_t<U>>) &&
+             std::is_constructible_v<Alternative<I>, U> && std::is_assignable_v<Alternative<I>&, U>
+  constexpr auto operator=(U &&value) -> Variant & {
+    if (index_ == I) {
+      this->UncheckedGet<I>() = tystl::Forward<U>(value);
+    } else {
+      this->Emplace<I>(tystl::Forward<U>(value));
+    }
+    return *this;
+  }
+
+  constexpr ~Variant() requires kTriviallyDestructible = default;
+
+  constexpr ~Variant() {
+    this->Destroy();
+  }
+
+public:
+  // The index of the held alternative, kVariantNpos if valueless.
+  constexpr auto Index() const noexcept -> std::size_t {
+    return this->ValuelessByException() ? kVariantNpos : index_;
+  }
+
+  constexpr auto ValuelessByException() const noexcept -> bool {
+    return !kNeverValueless && index_ == kValueless;
+  }
+
+  template <typename T>
+    requires kUnique<T>
+  constexpr auto Holds() const noexcept -> bool {
+    return index_ == kIndexOf<T>;
+  }
+
+  // Throw std::bad_variant_access unless alternative 'I' is held.
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto Get() & -> Alternative<I> & {
+    return this->CheckedGet<I>();
+  }
+
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto Get() const & -> const Alternative<I> & {
+    return const_cast<Variant*>(this)->CheckedGet<I>();
+  }
+
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto Get() && -> Alternative<I> && {
+    return tystl::Move(this->CheckedGet<I>());
+  }
+
+  template <typename T>
+    requires kUnique<T>
+  constexpr auto Get() & -> T & {
+    return this->CheckedGet<kIndexOf<T>>();
+  }
+
+  template <typename T>
+    requires kUnique<T>
+  constexpr auto Get() const & -> const T & {
+    return const_cast<Variant*>(this)->CheckedGet<kIndexOf<T>>();
+  }
+
+  template <typename T>
+    requires kUnique<T>
+  constexpr auto Get() && -> T && {
+    return tystl::Move(this->CheckedGet<kIndexOf<T>>());
+  }
+
+  // Null unless alternative 'I' is held.
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto GetIf() noexcept -> Alternative<I> * {
+    return index_ == I ? std::addressof(this->UncheckedGet<I>()) : nullptr;
+  }
+
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto GetIf() const noexcept -> const Alternative<I> * {
+    return const_cast<Variant*>(this)->GetIf<I>();
+  }
+
+  template <typename T>
+    requires kUnique<T>
+  constexpr auto GetIf() noexcept -> T * {
+    return this->GetIf<kIndexOf<T>>();
+  }
+
+  template <typename T>
+    requires kUnique<T>
+  constexpr auto GetIf() const noexcept -> const T * {
+    return const_cast<Variant*>(this)->GetIf<kIndexOf<T>>();
+  }
+
+  // Like 'Get', for callers that already know which alternative is held.
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto UncheckedGet() noexcept -> Alternative<I> & {
+    return variant_detail::GetAt<I>(storage_);
+  }
+
+  template <std::size_t I>
+    requires (I < kSize)
+  constexpr auto UncheckedGet() const noexcept -> const Alternative<I> & {
+    return variant_detail::GetAt<I>(storage_);
+  }
+
+  template <std::size_t I, typename... Args>
+    requires (I < kSize) && std::is_constructible_v<Alternative<I>, Args...>
+  constexpr auto Emplace(Args &&...args) -> Alternative<I> & {
+    if constexpr (kNeverValueless && !std::is_nothrow_constructible_v<Alternative<I>, Args...>) {
+      Alternative<I> value(tystl::Forward<Args>(args)...);
+      this->Destroy();
+      std::construct_at(std::addressof(this->UncheckedGet<I>()), tystl::Move(value));
+    } else {
+      this->Destroy();
+      std::construct_at(std::addressof(this->UncheckedGet<I>()), tystl::Forward<Args>(args)...);
+    }
+    index_ = I;
+    return this->UncheckedGet<I>();
+  }
+
+  template <typename T, typename... Args>
+    requires kUnique<T> && std::is_constructible_v<T, Args...>
+  constexpr auto Emplace(Args &&...args) -> T & {
+    return this->Emplace<kIndexOf<T>>(tystl::Forward<Args>(args)...);
+  }
+
+  constexpr auto Swap(Variant &other) noexcept((... && (std::is_nothrow_move_constructible_v<Ts> &&
+                                                       std::is_nothrow_swappable_v<Ts>))) -> void {
+    if (index_ == other.index_) {
+      if (index_ != kValueless) {
+        variant_detail::Dispatch<kSize>(index_, [&]<std::size_t I>() {
+          using std::swap;
+          swap(this->UncheckedGet<I>(), other.UncheckedGet<I>());
+        });
+      }
+      return;
+    }
+    Variant tmp(tystl::Move(other));
+    other = tystl::Move(*this);
+    *this = tystl::Move(tmp);
+  }
+
+private:
+  template <std::size_t I>
+  constexpr auto CheckedGet() -> Alternative<I> & {
+    if (index_ != I) {
+      throw std::bad_variant_access();
+    }
+    return this->UncheckedGet<I>();
+  }
+
+  constexpr auto Destroy() noexcept -> void {
+    if constexpr (!kTriviallyDestructible) {
+      if (index_ != kValueless) {
+        variant_detail::Dispatch<kSize>(index_, [this]<std::size_t I>() {
+          std::destroy_at(std::addressof(this->UncheckedGet<I>()));
+        });
+      }
+    }
+    index_ = kValueless;
+  }
+
+  // Builds the alternative 'other' holds, from 'other's value. Called on a
+  // Variant without a value.
+  template <typename V>
+  constexpr auto ConstructFrom(V &&other) -> void {
+    index_ = kValueless;
+    if (other.index_ != kValueless) {
+      variant_detail::Dispatch<kSize>(other.index_, [&]<std::size_t I>() {
+        std::construct_at(std::addressof(this->UncheckedGet<I>()), variant_detail::Forwarded<I>(tystl::Forward<V>(other)));
+      });
+      index_ = other.index_;
+    }
+  }
+
+  template <typename V>
+  constexpr auto AssignFrom(V &&other) -> void {
+    if (this == std::addressof(other)) {
+      return;
+    }
+    if (other.index_ == kValueless) {
+      this->Destroy();
+    } else if (index_ == other.index_) {
+      variant_detail::Dispatch<kSize>(index_, [&]<std::size_t I>() {
+        this->UncheckedGet<I>() = variant_detail::Forwarded<I>(tystl::Forward<V>(other));
+      });
+    } else if constexpr (std::is_lvalue_reference_v<V>) {
+      // A copy that may throw is made first, so the old value survives.
+      Variant tmp(other);
+      this->Destroy();
+      this->ConstructFrom(tystl::Move(tmp));
+    } else {
+      this->Destroy();
+      this->ConstructFrom(tystl::Forward<V>(other));
+    }
+  }
+
+private:
+  variant_detail::Union<Ts...> storage_;
+  Discriminator index_;
+};
+
+template <typename... Ts>
+  requires (... && std::equality_comparable<Ts>)
+constexpr auto operator==(const Variant<Ts...> &left, const Variant<Ts...> &right) -> bool {
+  if (left.Index() != right.Index()) {
+    return false;
+  }
+  if (left.ValuelessByException()) {
+    return true;
+  }
+  return variant_detail::Dispatch<sizeof...(Ts)>(left.Index(), [&]<std::size_t I>() -> bool {
+    return left.template UncheckedGet<I>() == right.template UncheckedGet<I>();
+  });
+}
+
+// Orders by index first, a valueless Variant before all others.
+template <typename... Ts>
+  requires (... && std::three_way_comparable<Ts>)
+constexpr auto operator<=>(const Variant<Ts...> &left, const Variant<Ts...> &right)
+    -> std::common_comparison_category_t<std::compare_three_way_result_t<Ts>...> {
+  using Result = std::common_comparison_category_t<std::compare_three_way_result_t<Ts>...>;
+  if (left.Index() != right.Index()) {
+    // kVariantNpos wraps to zero.
+    return left.Index() + 1 <=> right.Index() + 1;
+  }
+  if (left.ValuelessByException()) {
+    return std::strong_ordering::equal;
+  }
+  return variant_detail::Dispatch<sizeof...(Ts)>(left.Index(), [&]<std::size_t I>() -> Result {
+    return left.template UncheckedGet<I>() <=> right.template UncheckedGet<I>();
+  });
+}
+
+// Calls 'visitor' with the values held by 'variants', through one jump
+// table over all combinations of their alternatives. Throws
+// std::bad_variant_access if one of them is valueless. Every combination
+// must give the same result type.
+template <typename Visitor, typename... Vs>
+  requires (variant_detail::kIsVariant<std::remove_cvref_t<Vs>> && ...)
+constexpr auto Visit(Visitor &&visitor, Vs &&...variants) -> decltype(auto) {
+  if ((variants.ValuelessByException() || ...)) {
+    throw std::bad_variant_access();
+  }
+  constexpr std::size_t combinations = (std::size_t{1} * ... * std::remove_cvref_t<Vs>::kSize);
+  std::size_t flat = 0;
+  ((flat = flat * std::remove_cvref_t<Vs>::kSize + variants.Index()), ...);
+  return variant_detail::Dispatch<combinations>(flat, [&]<std::size_t Flat>() -> decltype(auto) {
+    constexpr auto indices = variant_detail::kUnflatten<Flat, Vs...>;
+    return [&]<std::size_t... K>(std::index_sequence<K...>) -> decltype(auto) {
+      return std::invoke(tystl::Forward<Visitor>(visitor),
+                         variant_detail::Forwarded<indices[K]>(tystl::Forward<Vs>(variants))...);
+    }(std::index_sequence_for<Vs...>());
+  });
+}
+
+template <typename... Ts>
+struct IsTriviallyRelocatable<Variant<Ts...>> : std::bool_constant<(IsTriviallyRelocatableValue<Ts> && ...)> {};
+
+static_assert(sizeof(Variant<std::uint32_t, float>) == 2 * sizeof(std::uint32_t));
+
+}
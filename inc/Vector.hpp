@@ -0,0 +1,599 @@
+#pragma once
+
+#include "GrowthPolicy.hpp"
+#include "Utility.hpp"
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace tystl {
+
+// Element moves shared by Vector and SmallVector. The memcpy/memmove paths
+// are taken for 'IsTriviallyRelocatable' types outside constant evaluation.
+namespace vector_detail {
+
+template <typename Alloc, typename T>
+constexpr void DestroyRange(Alloc &alloc, T *first, T *last) noexcept {
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    for (; first != last; ++first) {
+      std::allocator_traits<Alloc>::destroy(alloc, first);
+    }
+  }
+}
+
+// Moves 'count' elements from 'from' into the uninitialized 'to' and
+// destroys the originals. If a copy throws, 'to' is left empty and 'from'
+// untouched.
+template <typename Alloc, typename T>
+constexpr void Relocate(Alloc &alloc, T *from, std::size_t count, T *to) {
+  if !consteval {
+    if constexpr (IsTriviallyRelocatableValue<T>) {
+      if (count != 0) {
+        std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+      }
+      return;
+    }
+  }
+  std::size_t done = 0;
+  try {
+    for (; done < count; done++) {
+      std::allocator_traits<Alloc>::construct(alloc, to + done, std::move_if_noexcept(from[done]));
+    }
+  } catch (...) {
+    DestroyRange(alloc, to, to + done);
+    throw;
+  }
+  DestroyRange(alloc, from, from + count);
+}
+
+// Moves '*last' to 'first' and shifts [first, last) up one slot.
+template <typename T>
+constexpr void RotateIntoPlace(T *first, T *last) {
+  if (first == last) {
+    return;
+  }
+  if !consteval {
+    if constexpr (IsTriviallyRelocatableValue<T>) {
+      alignas(T) unsigned char slot[sizeof(T)];
+      std::memcpy(slot, static_cast<void*>(last), sizeof(T));
+      std::memmove(static_cast<void*>(first + 1), static_cast<void*>(first), (last - first) * sizeof(T));
+      std::memcpy(static_cast<void*>(first), slot, sizeof(T));
+      return;
+    }
+  }
+  T value = tystl::Move(*last);
+  std::move_backward(first, last, last + 1);
+  *first = tystl::Move(value);
+}
+
+// Removes [first, last) from the elements ending at 'stop' and returns the
+// new end.
+template <typename Alloc, typename T>
+constexpr T* EraseRange(Alloc &alloc, T *first, T *last, T *stop) {
+  if (first == last) {
+    return stop;
+  }
+  if !consteval {
+    if constexpr (IsTriviallyRelocatableValue<T>) {
+      DestroyRange(alloc, first, last);
+      std::memmove(static_cast<void*>(first), static_cast<void*>(last), (stop - last) * sizeof(T));
+      return stop - (last - first);
+    }
+  }
+  auto *new_stop = std::move(last, stop, first);
+  DestroyRange(alloc, new_stop, stop);
+  return new_stop;
+}
+
+} // namespace vector_detail
+
+// A growable array. Capacity grows as 'Growth' says (see GrowthPolicy.hpp).
+//
+// Elements that are 'IsTriviallyRelocatable' are moved to a new buffer with
+// memcpy and shifted by 'Insert' and 'Erase' with memmove, without running
+// any constructor or destructor; other elements are moved one by one, or
+// copied if their move constructor may throw.
+//
+// The lower case members are the standard container spellings, so a Vector
+// can back a BinaryHeap or be used with the standard algorithms.
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DefaultGrowth>
+class Vector {
+  using AllocTraits = std::allocator_traits<Alloc>;
+
+public:
+  using value_type             = T;
+  using allocator_type         = Alloc;
+  using size_type              = std::size_t;
+  using difference_type        = std::ptrdiff_t;
+  using pointer                = T*;
+  using const_pointer          = const T*;
+  using reference              = T&;
+  using const_reference        = const T&;
+  using iterator               = T*;
+  using const_iterator         = const T*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+
+public:
+  constexpr Vector() noexcept(noexcept(Alloc())) = default;
+
+  constexpr explicit Vector(const Alloc &alloc) noexcept : alloc_(alloc) {}
+
+  constexpr explicit Vector(size_type count, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Resize(count);
+  }
+
+  constexpr Vector(size_type count, const T &value, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Resize(count, value);
+  }
+
+  template <std::input_iterator InputIt>
+  constexpr Vector(InputIt first, InputIt last, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Append(first, last);
+  }
+
+  constexpr Vector(std::initializer_list<T> init, const Alloc &alloc = Alloc()) : alloc_(alloc) {
+    this->Append(init.begin(), init.end());
+  }
+
+  constexpr Vector(const Vector &other)
+      : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    this->Append(other.begin(), other.end());
+  }
+
+  constexpr Vector(Vector &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        alloc_(tystl::Move(other.alloc_)) {}
+
+  constexpr Vector& operator=(const Vector &other) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+      if (alloc_ != other.alloc_) {
+        this->Deallocate();
+      }
+      alloc_ = other.alloc_;
+    }
+    this->Assign(other.begin(), other.end());
+    return *this;
+  }
+
+  constexpr Vector& operator=(Vector &&other)
+    noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (!AllocTraits::propagate_on_container_move_assignment::value &&
+                  !AllocTraits::is_always_equal::value) {
+      // Memory from another allocator cannot be adopted, move the elements.
+      if (alloc_ != other.alloc_) {
+        this->Assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        other.Clear();
+        return *this;
+      }
+    }
+    this->Deallocate();
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+      alloc_ = tystl::Move(other.alloc_);
+    }
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    return *this;
+  }
+
+  constexpr Vector& operator=(std::initializer_list<T> init) {
+    this->Assign(init.begin(), init.end());
+    return *this;
+  }
+
+  constexpr ~Vector() {
+    this->Deallocate();
+  }
+
+  constexpr void Swap(Vector &other) noexcept {
+    tystl::Swap(data_, other.data_);
+    tystl::Swap(size_, other.size_);
+    tystl::Swap(capacity_, other.capacity_);
+    if constexpr (AllocTraits::propagate_on_container_swap::value) {
+      tystl::Swap(alloc_, other.alloc_);
+    }
+  }
+
+public:
+  [[nodiscard]]
+  constexpr allocator_type GetAllocator() const noexcept {
+    return alloc_;
+  }
+
+  [[nodiscard]]
+  constexpr size_type Size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]]
+  constexpr size_type Capacity() const noexcept {
+    return capacity_;
+  }
+
+  [[nodiscard]]
+  constexpr size_type MaxSize() const noexcept {
+    return AllocTraits::max_size(alloc_);
+  }
+
+  [[nodiscard]]
+  constexpr bool Empty() const noexcept {
+    return size_ == 0;
+  }
+
+  [[nodiscard]]
+  constexpr reference At(size_type pos) {
+    if (size_ <= pos) {
+      throw std::out_of_range("Vector::At");
+    }
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  constexpr const_reference At(size_type pos) const {
+    if (size_ <= pos) {
+      throw std::out_of_range("Vector::At");
+    }
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  constexpr reference operator[](size_type pos) noexcept {
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  constexpr const_reference operator[](size_type pos) const noexcept {
+    return data_[pos];
+  }
+
+  [[nodiscard]]
+  constexpr reference Front() noexcept {
+    return data_[0];
+  }
+
+  [[nodiscard]]
+  constexpr const_reference Front() const noexcept {
+    return data_[0];
+  }
+
+  [[nodiscard]]
+  constexpr reference Back() noexcept {
+    return data_[size_ - 1];
+  }
+
+  [[nodiscard]]
+  constexpr const_reference Back() const noexcept {
+    return data_[size_ - 1];
+  }
+
+  [[nodiscard]]
+  constexpr pointer Data() noexcept {
+    return data_;
+  }
+
+  [[nodiscard]]
+  constexpr const_pointer Data() const noexcept {
+    return data_;
+  }
+
+  // Makes room for at least 'capacity' elements without reallocating.
+  constexpr void Reserve(size_type capacity) {
+    if (capacity > capacity_) {
+      this->Reallocate(this->CheckedCapacity(capacity));
+    }
+  }
+
+  // Drops unused capacity, freeing the buffer when the Vector is empty.
+  constexpr void ShrinkToFit() {
+    if (size_ == capacity_) {
+      return;
+    }
+    if (size_ == 0) {
+      this->Deallocate();
+    } else {
+      this->Reallocate(size_);
+    }
+  }
+
+  constexpr void Clear() noexcept {
+    this->DestroyRange(data_, data_ + size_);
+    size_ = 0;
+  }
+
+  constexpr void Resize(size_type count) {
+    this->ResizeWith(count, [&](T *slot) { AllocTraits::construct(alloc_, slot); });
+  }
+
+  constexpr void Resize(size_type count, const T &value) {
+    this->ResizeWith(count, [&](T *slot) { AllocTraits::construct(alloc_, slot, value); });
+  }
+
+  template <typename ...Args>
+    requires std::is_constructible_v<T, Args...>
+  constexpr reference EmplaceBack(Args &&...args) {
+    if (size_ != capacity_) [[likely]] {
+      AllocTraits::construct(alloc_, data_ + size_, tystl::Forward<Args>(args)...);
+      return data_[size_++];
+    }
+    return this->EmplaceBackGrow(tystl::Forward<Args>(args)...);
+  }
+
+  constexpr void PushBack(const T &value) {
+    this->EmplaceBack(value);
+  }
+
+  constexpr void PushBack(T &&value) {
+    this->EmplaceBack(tystl::Move(value));
+  }
+
+  constexpr void PopBack() noexcept {
+    AllocTraits::destroy(alloc_, data_ + --size_);
+  }
+
+  // Constructs an element in front of 'pos' and returns an iterator to it.
+  template <typename ...Args>
+    requires std::is_constructible_v<T, Args...>
+  constexpr iterator Emplace(const_iterator pos, Args &&...args) {
+    // Built at the end first, since 'args' may refer into the Vector.
+    auto index = static_cast<size_type>(pos - data_);
+    this->EmplaceBack(tystl::Forward<Args>(args)...);
+    vector_detail::RotateIntoPlace(data_ + index, data_ + size_ - 1);
+    return data_ + index;
+  }
+
+  constexpr iterator Insert(const_iterator pos, const T &value) {
+    return this->Emplace(pos, value);
+  }
+
+  constexpr iterator Insert(const_iterator pos, T &&value) {
+    return this->Emplace(pos, tystl::Move(value));
+  }
+
+  // Removes the element at 'pos', returns an iterator to the one after it.
+  constexpr iterator Erase(const_iterator pos) {
+    return this->Erase(pos, pos + 1);
+  }
+
+  constexpr iterator Erase(const_iterator first, const_iterator last) {
+    auto *begin = data_ + (first - data_);
+    auto *stop = vector_detail::EraseRange(alloc_, begin, data_ + (last - data_), data_ + size_);
+    size_ = static_cast<size_type>(stop - data_);
+    return begin;
+  }
+
+  template <std::input_iterator InputIt>
+  constexpr void Assign(InputIt first, InputIt last) {
+    this->Clear();
+    this->Append(first, last);
+  }
+
+  [[nodiscard]]
+  constexpr bool operator==(const Vector &right) const {
+    return std::equal(begin(), end(), right.begin(), right.end());
+  }
+
+  [[nodiscard]]
+  constexpr auto operator<=>(const Vector &right) const
+    requires std::three_way_comparable<T> {
+    return std::lexicographical_compare_three_way(begin(), end(), right.begin(), right.end());
+  }
+
+public:
+  constexpr iterator begin() noexcept {
+    return data_;
+  }
+
+  constexpr const_iterator begin() const noexcept {
+    return data_;
+  }
+
+  constexpr iterator end() noexcept {
+    return data_ + size_;
+  }
+
+  constexpr const_iterator end() const noexcept {
+    return data_ + size_;
+  }
+
+  constexpr const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  constexpr const_iterator cend() const noexcept {
+    return end();
+  }
+
+  constexpr reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  constexpr const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  constexpr reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  constexpr const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  constexpr size_type size() const noexcept {
+    return size_;
+  }
+
+  constexpr bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  constexpr reference front() noexcept {
+    return this->Front();
+  }
+
+  constexpr const_reference front() const noexcept {
+    return this->Front();
+  }
+
+  constexpr reference back() noexcept {
+    return this->Back();
+  }
+
+  constexpr const_reference back() const noexcept {
+    return this->Back();
+  }
+
+  constexpr void push_back(const T &value) {
+    this->EmplaceBack(value);
+  }
+
+  constexpr void push_back(T &&value) {
+    this->EmplaceBack(tystl::Move(value));
+  }
+
+  template <typename ...Args>
+  constexpr reference emplace_back(Args &&...args) {
+    return this->EmplaceBack(tystl::Forward<Args>(args)...);
+  }
+
+  constexpr void pop_back() noexcept {
+    this->PopBack();
+  }
+
+private:
+  constexpr size_type CheckedCapacity(size_type capacity) const {
+    if (capacity > this->MaxSize()) {
+      throw std::length_error("Vector");
+    }
+    return capacity;
+  }
+
+  constexpr size_type NextCapacity(size_type required) const {
+    return this->CheckedCapacity(Growth::Grow(capacity_, required));
+  }
+
+  constexpr void Reallocate(size_type capacity) {
+    auto *data = AllocTraits::allocate(alloc_, capacity);
+    try {
+      vector_detail::Relocate(alloc_, data_, size_, data);
+    } catch (...) {
+      AllocTraits::deallocate(alloc_, data, capacity);
+      throw;
+    }
+    this->ReleaseBuffer();
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  // The new element is built in the new buffer before the old elements are
+  // moved, so 'args' may refer to an element of this Vector.
+  template <typename ...Args>
+  constexpr reference EmplaceBackGrow(Args &&...args) {
+    auto capacity = this->NextCapacity(size_ + 1);
+    auto *data = AllocTraits::allocate(alloc_, capacity);
+    try {
+      AllocTraits::construct(alloc_, data + size_, tystl::Forward<Args>(args)...);
+    } catch (...) {
+      AllocTraits::deallocate(alloc_, data, capacity);
+      throw;
+    }
+    try {
+      vector_detail::Relocate(alloc_, data_, size_, data);
+    } catch (...) {
+      AllocTraits::destroy(alloc_, data + size_);
+      AllocTraits::deallocate(alloc_, data, capacity);
+      throw;
+    }
+    this->ReleaseBuffer();
+    data_ = data;
+    capacity_ = capacity;
+    return data_[size_++];
+  }
+
+  template <typename Construct>
+  constexpr void ResizeWith(size_type count, Construct construct) {
+    if (count <= size_) {
+      this->DestroyRange(data_ + count, data_ + size_);
+      size_ = count;
+      return;
+    }
+    if (count > capacity_) {
+      this->Reallocate(this->NextCapacity(count));
+    }
+    for (; size_ < count; size_++) {
+      construct(data_ + size_);
+    }
+  }
+
+  template <typename InputIt>
+  constexpr void Append(InputIt first, InputIt last) {
+    if constexpr (std::forward_iterator<InputIt>) {
+      auto count = static_cast<size_type>(std::distance(first, last));
+      if (size_ + count > capacity_) {
+        this->Reallocate(this->NextCapacity(size_ + count));
+      }
+      for (; first != last; ++first) {
+        AllocTraits::construct(alloc_, data_ + size_, *first);
+        size_++;
+      }
+    } else {
+      for (; first != last; ++first) {
+        this->EmplaceBack(*first);
+      }
+    }
+  }
+
+  constexpr void DestroyRange(T *first, T *last) noexcept {
+    vector_detail::DestroyRange(alloc_, first, last);
+  }
+
+  // Frees the buffer without destroying the elements it held.
+  constexpr void ReleaseBuffer() noexcept {
+    if (data_ != nullptr) {
+      AllocTraits::deallocate(alloc_, data_, capacity_);
+    }
+  }
+
+  constexpr void Deallocate() noexcept {
+    this->Clear();
+    this->ReleaseBuffer();
+    data_ = nullptr;
+    capacity_ = 0;
+  }
+
+private:
+  T *data_ = nullptr;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+  [[no_unique_address]] Alloc alloc_;
+};
+
+// The buffer is owned through a plain pointer, only a stateful allocator
+// could refer back to the Vector.
+template <typename T, typename Alloc, typename Growth>
+struct IsTriviallyRelocatable<Vector<T, Alloc, Growth>>
+    : std::bool_constant<std::is_empty_v<Alloc> || IsTriviallyRelocatableValue<Alloc>> {};
+
+template <std::input_iterator InputIt>
+Vector(InputIt, InputIt) -> Vector<std::iter_value_t<InputIt>>;
+
+}
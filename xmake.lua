@@ -4,20 +4,64 @@ set_languages("c++23")
 set_warnings("all", "extra", "error")
 set_toolchains("clang")
 
+-- The parallel algorithms in the benchmarks run on TBB with libstdc++.
+add_requires("tbb", {optional = true})
+
 add_includedirs("inc")
 
+-- 'xmake f --instrument=y' compiles in the counters of inc/Instrument.hpp.
+option("instrument")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Count allocations, reference count changes and heap work")
+    add_defines("TYSTL_INSTRUMENT=1")
+option_end()
+
 target("main")
     set_kind("binary")
     add_files("main.cpp")
+    add_options("instrument")
     set_pcxxheader("inc/Any.hpp")
+    set_pcxxheader("inc/Arena.hpp")
+    set_pcxxheader("inc/AtomicSharedPtr.hpp")
     set_pcxxheader("inc/Array.hpp")
+    set_pcxxheader("inc/Backoff.hpp")
     set_pcxxheader("inc/BinaryHeap.hpp")
     set_pcxxheader("inc/Concept.hpp")
+    set_pcxxheader("inc/ConcurrentPriorityQueue.hpp")
+    set_pcxxheader("inc/FlatHashMap.hpp")
+    set_pcxxheader("inc/Function.hpp")
+    set_pcxxheader("inc/GrowthPolicy.hpp")
+    set_pcxxheader("inc/Hash.hpp")
+    set_pcxxheader("inc/Instrument.hpp")
+    set_pcxxheader("inc/IntrusivePtr.hpp")
+    set_pcxxheader("inc/MemoryResource.hpp")
+    set_pcxxheader("inc/MpmcQueue.hpp")
     set_pcxxheader("inc/Optional.hpp")
+    set_pcxxheader("inc/Pool.hpp")
+    set_pcxxheader("inc/Reclaim.hpp")
     set_pcxxheader("inc/SharedPtr.hpp")
+    set_pcxxheader("inc/SmallVector.hpp")
+    set_pcxxheader("inc/SpscQueue.hpp")
+    set_pcxxheader("inc/String.hpp")
+    set_pcxxheader("inc/StringView.hpp")
+    set_pcxxheader("inc/ThreadPool.hpp")
     set_pcxxheader("inc/TypeTraits.hpp")
     set_pcxxheader("inc/UniquePtr.hpp")
     set_pcxxheader("inc/Utility.hpp")
+    set_pcxxheader("inc/Variant.hpp")
+    set_pcxxheader("inc/Vector.hpp")
+
+-- Microbenchmarks, built with 'xmake build bench'. 'xmake run bench --help'
+-- lists the options, e.g. '--format=csv --out=base.csv' to save a baseline
+-- and '--baseline=base.csv' to compare a later run against it.
+target("bench")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/*.cpp")
+    add_options("instrument")
+    add_packages("tbb")
+    add_syslinks("pthread")
 
 --
 -- If you want to known more usage about xmake, please see https://xmake.io